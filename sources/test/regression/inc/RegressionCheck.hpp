@@ -0,0 +1,59 @@
+#ifndef REGRESSION_CHECK_H
+#define REGRESSION_CHECK_H
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Failed checks so far; main() returns it.
+ */
+inline int regressionFailures = 0;
+
+#define CHECK(CONDITION) \
+    do { \
+        if (!(CONDITION)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #CONDITION); \
+            ++regressionFailures; \
+        } \
+    } while(0)
+
+/**
+ * @brief Returns the lines of @p path, or none if it cannot be read.
+ */
+inline std::vector<std::string> readLines(const std::string& path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * @brief Counts the lines of @p path that contain @p text.
+ */
+inline size_t countLines(const std::string& path, const std::string& text)
+{
+    size_t count = 0;
+    for (const std::string& line : readLines(path)) {
+        if (line.find(text) != std::string::npos) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Removes @p path so a test starts from a clean file.
+ */
+inline void removeFile(const std::string& path)
+{
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+#endif // REGRESSION_CHECK_H
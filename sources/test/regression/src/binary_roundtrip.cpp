@@ -0,0 +1,170 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+#include <climits>
+#include <cmath>
+
+/**
+ * A binary log decodes to the text the logger writes for the same
+ * records: every argument type, records cut at the buffer size, and
+ * records that went to a rotated segment. The two formats measure the
+ * size limit differently, so a cut record must only keep the same
+ * beginning in both.
+ */
+
+static void writeRecords()
+{
+    int local = 0;
+    std::string longText(LogBuffer::BUFFER_SIZE, 'x');
+
+    LOG_PRINT(LOG_VERBOSE, LOG_STRING("strings"); LOG_STRING(std::string("std")); LOG_STRING(std::string_view("view")));
+    LOG_PRINT(LOG_DEBUG, LOG_PTR(&local); LOG_PTR(static_cast<const int*>(nullptr)));
+    LOG_PRINT(LOG_INFO, LOG_BOOL(true); LOG_BOOL(false); LOG_CHAR('c'));
+    LOG_PRINT(LOG_WARNING, LOG_UINT8(UINT8_MAX); LOG_UINT16(UINT16_MAX); LOG_UINT32(UINT32_MAX); LOG_UINT64(UINT64_MAX);
+              LOG_SIZET(SIZE_MAX));
+    LOG_PRINT(LOG_ERROR, LOG_INT8(INT8_MIN); LOG_INT16(INT16_MIN); LOG_INT32(INT32_MIN); LOG_INT64(INT64_MIN);
+              LOG_INT(-1); LOG_INT(0));
+    LOG_PRINT(LOG_INFO, LOG_FLOAT(0.1f); LOG_DOUBLE(-1.5e300); LOG_DOUBLE(1e-9); LOG_DOUBLE(NAN); LOG_DOUBLE(-INFINITY));
+    LOG_PRINT(LOG_INFO, LOG_HEX8(0xAB); LOG_HEX16(0xBEEF); LOG_HEX32(0xDEADBEEF); LOG_HEX64(UINT64_MAX);
+              LOG_HEXSIZET(SIZE_MAX));
+    LOG_PRINT(LOG_FATAL, LOG_STRING("fatal"); LOG_INT(42));
+
+    // Cut at the buffer size, in the middle of an argument list and inside one argument
+    LOG_PRINT(LOG_INFO, LOG_STRING("long"); LOG_STRING(longText); LOG_INT(1));
+    LOG_PRINT(LOG_INFO, LOG_STRING(longText.substr(0, LogBuffer::BUFFER_SIZE - 8)); LOG_INT(123456789); LOG_INT(2));
+
+    // Enough to rotate a couple of times
+    for (int i = 0; i < 400; ++i) {
+        LOG_PRINT(LOG_INFO, LOG_STRING("rotation record"); LOG_INT(i); LOG_DOUBLE(i / 8.0); LOG_HEX32(i));
+    }
+}
+
+/**
+ * @brief Writes writeRecords() in @p format, rotating every @p rotateBytes, and returns the segment paths in order.
+ */
+static std::vector<std::string> logTo(const std::string& base, LogFileFormat format, size_t rotateBytes)
+{
+    for (size_t i = 0; std::filesystem::exists(LogBuffer::segmentPath(base, i)); ++i) {
+        removeFile(LogBuffer::segmentPath(base, i));
+    }
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FIXED, LOG_VERBOSE, false, false, true);
+    log_local->setFileFormat(format);
+    log_local->setFileRotation(rotateBytes);
+    log_local->enableFileLogging(base);
+    writeRecords();
+    log_local->disableFileLogging();
+    CHECK(log_local->shutdown(std::chrono::seconds(5)).complete);
+
+    std::vector<std::string> segments;
+    for (size_t i = 0; std::filesystem::exists(LogBuffer::segmentPath(base, i)); ++i) {
+        segments.push_back(LogBuffer::segmentPath(base, i));
+    }
+    return segments;
+}
+
+static constexpr const char* TRUNCATED_MARK = " [TRUNCATED]";
+
+/**
+ * @brief The part of a text line after its timestamp: "LEVEL | message".
+ */
+static std::string withoutTimestamp(const std::string& line)
+{
+    size_t bar = line.find(" | ");
+    return bar == std::string::npos ? line : line.substr(bar + 3);
+}
+
+static std::vector<std::string> decodeSegments(const std::vector<std::string>& segments)
+{
+    std::vector<std::string> lines;
+    for (const std::string& path : segments) {
+        std::ifstream in(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        binlog::StreamDecoder decoder;
+        decoder.feed(data.data(), data.size());
+        binlog::Record record;
+        while (decoder.next(record)) {
+            std::string line = toString(static_cast<LogLevel>(record.level));
+            line += " | ";
+            CHECK(binlog::renderArgs(record.args, record.argsSize, line));
+            if (record.truncated) {
+                line += TRUNCATED_MARK;
+            }
+            lines.push_back(line);
+        }
+        CHECK(!decoder.corrupt);
+        CHECK(!decoder.hasPartial());
+    }
+    return lines;
+}
+
+/**
+ * @brief Strips the truncation mark and the trailing argument separators.
+ */
+static std::string cutBody(std::string line)
+{
+    line.resize(line.size() - std::strlen(TRUNCATED_MARK));
+    while (!line.empty() && line.back() == ' ') {
+        line.pop_back();
+    }
+    return line;
+}
+
+static bool isTruncated(const std::string& line)
+{
+    size_t mark = std::strlen(TRUNCATED_MARK);
+    return line.size() >= mark && line.compare(line.size() - mark, mark, TRUNCATED_MARK) == 0;
+}
+
+static bool sameRecord(const std::string& text, const std::string& decoded)
+{
+    if (!isTruncated(text) && !isTruncated(decoded)) {
+        return text == decoded;
+    }
+    if (!isTruncated(text) || !isTruncated(decoded)) return false;
+    std::string a = cutBody(text);
+    std::string b = cutBody(decoded);
+    const std::string& shorter = a.size() < b.size() ? a : b;
+    const std::string& longer = a.size() < b.size() ? b : a;
+    // The longer cut may end inside an argument the shorter one dropped
+    return longer.compare(0, shorter.size(), shorter) == 0 && longer.size() - shorter.size() < 64;
+}
+
+static std::vector<std::string> readSegments(const std::vector<std::string>& segments)
+{
+    std::vector<std::string> lines;
+    for (const std::string& path : segments) {
+        for (const std::string& line : readLines(path)) {
+            lines.push_back(withoutTimestamp(line));
+        }
+    }
+    return lines;
+}
+
+int main()
+{
+    std::vector<std::string> textSegments = logTo("roundtrip.txt", LogFileFormat::TEXT, 16 * 1024);
+    std::vector<std::string> binarySegments = logTo("roundtrip.ulog", LogFileFormat::BINARY, 4 * 1024);
+    CHECK(binarySegments.size() >= 3);
+
+    std::vector<std::string> text = readSegments(textSegments);
+    std::vector<std::string> decoded = decodeSegments(binarySegments);
+    CHECK(text.size() == decoded.size());
+    for (size_t i = 0; i < std::min(text.size(), decoded.size()); ++i) {
+        if (!sameRecord(text[i], decoded[i])) {
+            std::fprintf(stderr, "record %zu differs:\n  text:   %.200s\n  binary: %.200s\n", i, text[i].c_str(),
+                         decoded[i].c_str());
+            ++regressionFailures;
+        }
+    }
+    CHECK(countLines(textSegments[0], "[TRUNCATED]") == 2);
+
+    for (const std::string& path : textSegments) {
+        removeFile(path);
+    }
+    for (const std::string& path : binarySegments) {
+        removeFile(path);
+    }
+    return regressionFailures;
+}
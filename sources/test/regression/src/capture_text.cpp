@@ -0,0 +1,52 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+/**
+ * Records below the console threshold must keep their text in a plain-text
+ * file while the arguments are also captured in binary form.
+ */
+
+static void flightRecorderKeepsFileText()
+{
+    const std::string path = "capture_flight.txt";
+    removeFile(path);
+
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_ERROR, LOG_VERBOSE, false, false, false);
+    log_local->setFlightRecorder(64 * 1024, false);
+    log_local->enableFileLogging(path);
+
+    LOG_PRINT(LOG_INFO, LOG_STRING("info record"); LOG_INT(42));
+    LOG_PRINT(LOG_WARNING, LOG_STRING("warning record"));
+    log_local->disableFileLogging();
+
+    CHECK(countLines(path, "info record 42") == 1);
+    CHECK(countLines(path, "warning record") == 1);
+}
+
+static void backtraceKeepsFileText()
+{
+    const std::string path = "capture_backtrace.txt";
+    removeFile(path);
+
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_ERROR, LOG_VERBOSE, false, false, false);
+    log_local->setBacktrace(16);
+    log_local->enableFileLogging(path);
+
+    LOG_PRINT(LOG_DEBUG, LOG_STRING("debug record"); LOG_INT(7));
+    LOG_PRINT(LOG_VERBOSE, LOG_STRING("verbose record"));
+    log_local->disableFileLogging();
+
+    CHECK(countLines(path, "debug record 7") == 1);
+    CHECK(countLines(path, "verbose record") == 1);
+}
+
+int main()
+{
+    flightRecorderKeepsFileText();
+    backtraceKeepsFileText();
+    return regressionFailures;
+}
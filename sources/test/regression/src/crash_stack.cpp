@@ -0,0 +1,59 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * A stack overflow still reaches the crash handler, which runs on the
+ * alternate signal stack and writes its crash record to the file.
+ */
+
+static int recurse(volatile char* previous)
+{
+    volatile char frame[1024];
+    frame[0] = previous ? previous[0] : 1;
+    return recurse(frame) + frame[0];
+}
+
+static void overflowWritesCrashRecord(bool ownThread)
+{
+    const std::string path = ownThread ? "crash_stack_thread.txt" : "crash_stack.txt";
+    removeFile(path);
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        struct rlimit noCore {0, 0};
+        ::setrlimit(RLIMIT_CORE, &noCore);
+        auto logger = std::make_shared<LogBuffer>();
+        setLogger(logger);
+        LOG_INIT(LOG_FIXED, LOG_VERBOSE, false, false, false);
+        log_local->setFlushPolicy(FlushPolicy::NEVER);
+        log_local->enableFileLogging(path);
+        log_local->setCrashHandler(true);
+        LOG_PRINT(LOG_INFO, LOG_STRING("before overflow"));
+        if (ownThread) {
+            std::thread([] {
+                LogBuffer::installCrashSignalStack();
+                recurse(nullptr);
+            }).join();
+        }
+        recurse(nullptr);
+        ::_exit(0);
+    }
+    CHECK(child > 0);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+    CHECK(countLines(path, "before overflow") == 1);
+    CHECK(countLines(path, "crash: SIGSEGV") == 1);
+    removeFile(path);
+}
+
+int main()
+{
+    overflowWritesCrashRecord(false);
+    overflowWritesCrashRecord(true);
+    return regressionFailures;
+}
@@ -0,0 +1,72 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Closing a preallocated file must not cut off bytes another writer
+ * appended, nor pad a file that logrotate's copytruncate emptied.
+ */
+
+static void startLogger(const std::string& path, FileIoMode mode)
+{
+    removeFile(path);
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    log_local->setFileIoMode(mode);
+    log_local->enableFileLogging(path);
+}
+
+static bool hasNul(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return content.find('\0') != std::string::npos;
+}
+
+static void keepsExternalAppends(FileIoMode mode)
+{
+    const std::string path = "extent_append.txt";
+    startLogger(path, mode);
+    LOG_PRINT(LOG_INFO, LOG_STRING("own record"));
+    LOG_FLUSH();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+    CHECK(fd >= 0);
+    const char line[] = "external record\n";
+    CHECK(::write(fd, line, sizeof(line) - 1) == static_cast<ssize_t>(sizeof(line) - 1));
+    ::close(fd);
+    log_local->disableFileLogging();
+
+    CHECK(countLines(path, "own record") == 1);
+    CHECK(countLines(path, "external record") == 1);
+}
+
+static void survivesCopyTruncate(FileIoMode mode)
+{
+    const std::string path = "extent_truncate.txt";
+    startLogger(path, mode);
+    for (int i = 0; i < 100; ++i) {
+        LOG_PRINT(LOG_INFO, LOG_STRING("before truncate"); LOG_INT(i));
+    }
+    LOG_FLUSH();
+
+    std::filesystem::resize_file(path, 0);
+    LOG_PRINT(LOG_INFO, LOG_STRING("after truncate"));
+    log_local->disableFileLogging();
+
+    CHECK(!hasNul(path));
+    CHECK(countLines(path, "before truncate") == 0);
+    CHECK(countLines(path, "after truncate") == 1);
+}
+
+int main()
+{
+    for (FileIoMode mode : {FileIoMode::AUTO, FileIoMode::FD}) {
+        keepsExternalAppends(mode);
+        survivesCopyTruncate(mode);
+    }
+    return regressionFailures;
+}
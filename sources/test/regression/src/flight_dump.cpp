@@ -0,0 +1,54 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+/**
+ * Each FATAL record gets its own flight recorder dump, even several in
+ * the same second, and the dump is on disk when LOG_PRINT returns.
+ */
+
+static std::vector<std::string> dumps(const std::string& prefix)
+{
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) == 0) {
+            paths.push_back(name);
+        }
+    }
+    return paths;
+}
+
+int main()
+{
+    const std::string prefix = "flight_dump_test";
+    for (const std::string& path : dumps(prefix)) {
+        removeFile(path);
+    }
+
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    log_local->setFlightRecorder(64 * 1024, false, prefix);
+
+    LOG_PRINT(LOG_DEBUG, LOG_STRING("first context"));
+    LOG_PRINT(LOG_FATAL, LOG_STRING("first fatal"));
+    CHECK(dumps(prefix).size() == 1);
+    LOG_PRINT(LOG_DEBUG, LOG_STRING("second context"));
+    LOG_PRINT(LOG_FATAL, LOG_STRING("second fatal"));
+    CHECK(dumps(prefix).size() == 2);
+    CHECK(log_local->shutdown(std::chrono::seconds(5)).complete);
+
+    std::vector<std::string> written = dumps(prefix);
+    CHECK(written.size() == 2);
+    size_t firstFatal = 0;
+    size_t secondFatal = 0;
+    for (const std::string& path : written) {
+        CHECK(countLines(path, "first context") == 1);
+        firstFatal += countLines(path, "first fatal");
+        secondFatal += countLines(path, "second fatal");
+        removeFile(path);
+    }
+    CHECK(firstFatal == 2);
+    CHECK(secondFatal == 1);
+    return regressionFailures;
+}
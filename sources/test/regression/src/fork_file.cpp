@@ -0,0 +1,91 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * A forked child and its parent log to files under each fork policy;
+ * every record of both processes must survive.
+ */
+
+static constexpr int RECORDS = 100;
+
+static void logFromBoth(const std::string& path, FileIoMode mode, ForkFilePolicy policy)
+{
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    log_local->setFileIoMode(mode);
+    log_local->setForkFilePolicy(policy);
+    log_local->enableFileLogging(path);
+    LOG_PRINT(LOG_INFO, LOG_STRING("before fork"));
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        for (int i = 0; i < RECORDS; ++i) {
+            LOG_PRINT(LOG_INFO, LOG_STRING("child record"); LOG_INT(i));
+        }
+        log_local->disableFileLogging();
+        ::_exit(0);
+    }
+    CHECK(child > 0);
+    for (int i = 0; i < RECORDS; ++i) {
+        LOG_PRINT(LOG_INFO, LOG_STRING("parent record"); LOG_INT(i));
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    // Forking leaves the parent's backend alone; only SAME_FILE asks for SHARED
+    CHECK(log_local->fileOptions.ioMode == (policy == ForkFilePolicy::SAME_FILE ? FileIoMode::SHARED : mode));
+    log_local->disableFileLogging();
+
+    if (policy == ForkFilePolicy::PER_PROCESS) {
+        std::string childPath = path.substr(0, path.size() - 4) + "_" + std::to_string(child) + ".txt";
+        CHECK(countLines(childPath, "child record") == RECORDS);
+        CHECK(countLines(childPath, "before fork") == 0);
+        removeFile(childPath);
+    } else {
+        CHECK(countLines(path, "child record") == RECORDS);
+    }
+    CHECK(countLines(path, "parent record") == RECORDS);
+    CHECK(countLines(path, "before fork") == 1);
+}
+
+static void silentChildLeavesNoFile()
+{
+    const std::string path = "fork_silent.txt";
+    removeFile(path);
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    log_local->enableFileLogging(path);
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        ::_exit(0);
+    }
+    CHECK(child > 0);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    LOG_PRINT(LOG_INFO, LOG_STRING("parent record"));
+    log_local->disableFileLogging();
+
+    // The default PER_PROCESS policy opens the child's file on its first record only
+    CHECK(!std::filesystem::exists("fork_silent_" + std::to_string(child) + ".txt"));
+    CHECK(countLines(path, "parent record") == 1);
+}
+
+int main()
+{
+    silentChildLeavesNoFile();
+    for (FileIoMode mode : {FileIoMode::AUTO, FileIoMode::FD, FileIoMode::IO_URING}) {
+        for (ForkFilePolicy policy : {ForkFilePolicy::SAME_FILE, ForkFilePolicy::PER_PROCESS}) {
+            std::string path = "fork_" + std::to_string(static_cast<int>(mode)) + "_" +
+                               std::to_string(static_cast<int>(policy)) + ".txt";
+            removeFile(path);
+            logFromBoth(path, mode, policy);
+        }
+    }
+    return regressionFailures;
+}
@@ -0,0 +1,59 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+#include <csignal>
+
+/**
+ * The reopen poll runs only while file logging is on, and comes back
+ * with the file.
+ */
+
+static bool pollArmed()
+{
+    std::lock_guard<std::mutex> lock(log_local->logMutex);
+    return log_local->reopenPollArmed;
+}
+
+static void waitPolls()
+{
+    std::this_thread::sleep_for(LogBuffer::REOPEN_POLL_INTERVAL * 3);
+}
+
+int main()
+{
+    const std::string path = "reopen_signal.txt";
+    const std::string rotated = "reopen_signal.txt.1";
+    removeFile(path);
+    removeFile(rotated);
+
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    log_local->enableFileLogging(path);
+    log_local->enableReopenOnSignal(SIGHUP);
+    CHECK(pollArmed());
+
+    log_local->disableFileLogging();
+    waitPolls();
+    CHECK(!pollArmed());
+
+    // Asks for nothing while no file is open
+    std::raise(SIGHUP);
+    log_local->enableFileLogging(path);
+    CHECK(pollArmed());
+    LOG_PRINT(LOG_INFO, LOG_STRING("before rotation"));
+    LOG_FLUSH();
+
+    std::filesystem::rename(path, rotated);
+    std::raise(SIGHUP);
+    waitPolls();
+    LOG_PRINT(LOG_INFO, LOG_STRING("after rotation"));
+    log_local->disableFileLogging();
+
+    CHECK(countLines(rotated, "before rotation") == 1);
+    CHECK(countLines(rotated, "after rotation") == 0);
+    CHECK(countLines(path, "after rotation") == 1);
+    removeFile(path);
+    removeFile(rotated);
+    return regressionFailures;
+}
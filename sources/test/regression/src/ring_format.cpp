@@ -0,0 +1,84 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+/**
+ * A ring file keeps the record format it was created with: reopening it
+ * in the same format resumes it, in another format starts it over.
+ */
+
+static void writeRing(const std::string& path, LogFileFormat format, const char* text)
+{
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    log_local->setFileRing(64 * 1024);
+    log_local->setFileFormat(format);
+    log_local->enableFileLogging(path);
+    LOG_PRINT(LOG_INFO, LOG_STRING(text));
+    log_local->disableFileLogging();
+}
+
+static std::vector<std::string> readRing(const std::string& path, RingHeader& header)
+{
+    std::vector<std::string> records;
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    CHECK(in != nullptr);
+    if (!in) return records;
+    CHECK(readRingFile(in, [&](const char* data, size_t size) { records.emplace_back(data, size); }, header));
+    std::fclose(in);
+    return records;
+}
+
+static size_t countRecords(const std::vector<std::string>& records, const std::string& text)
+{
+    size_t count = 0;
+    for (const std::string& record : records) {
+        if (record.find(text) != std::string::npos) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static void resumesSameFormat()
+{
+    const std::string path = "ring_resume.ring";
+    removeFile(path);
+    writeRing(path, LogFileFormat::TEXT, "first text");
+    writeRing(path, LogFileFormat::TEXT, "second text");
+
+    RingHeader header {};
+    std::vector<std::string> records = readRing(path, header);
+    CHECK((header.flags & RING_BINARY) == 0);
+    CHECK(countRecords(records, "first text") == 1);
+    CHECK(countRecords(records, "second text") == 1);
+    removeFile(path);
+}
+
+static void restartsOnFormatChange()
+{
+    const std::string path = "ring_format.ring";
+    removeFile(path);
+    writeRing(path, LogFileFormat::TEXT, "text record");
+    writeRing(path, LogFileFormat::BINARY, "binary record");
+
+    RingHeader header {};
+    std::vector<std::string> records = readRing(path, header);
+    CHECK((header.flags & RING_BINARY) != 0);
+    CHECK(countRecords(records, "text record") == 0);
+    CHECK(countRecords(records, "binary record") == 1);
+
+    writeRing(path, LogFileFormat::TEXT, "text again");
+    records = readRing(path, header);
+    CHECK((header.flags & RING_BINARY) == 0);
+    CHECK(countRecords(records, "binary record") == 0);
+    CHECK(countRecords(records, "text again") == 1);
+    removeFile(path);
+}
+
+int main()
+{
+    resumesSameFormat();
+    restartsOnFormatChange();
+    return regressionFailures;
+}
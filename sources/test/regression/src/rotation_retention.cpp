@@ -0,0 +1,51 @@
+#include "uLogger.hpp"
+#include "RegressionCheck.hpp"
+
+/**
+ * Size rotation set after a retention policy must keep that policy's
+ * file cap.
+ */
+
+static size_t countSegments(const std::string& prefix)
+{
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static void removeSegments(const std::string& prefix)
+{
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+            removeFile(entry.path().string());
+        }
+    }
+}
+
+int main()
+{
+    const std::string prefix = "rotation_kept";
+    removeSegments(prefix);
+
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FATAL, LOG_VERBOSE, false, false, false);
+    RetentionPolicy retention;
+    retention.maxFiles = 3;
+    log_local->setRetentionPolicy(retention);
+    log_local->setFileRotation(4096);
+    log_local->enableFileLogging(prefix + ".txt");
+
+    for (int i = 0; i < 2000; ++i) {
+        LOG_PRINT(LOG_INFO, LOG_STRING("rotation record"); LOG_INT(i));
+    }
+    log_local->disableFileLogging();
+
+    CHECK(countSegments(prefix) == 3);
+    removeSegments(prefix);
+    return regressionFailures;
+}
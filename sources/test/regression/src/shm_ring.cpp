@@ -0,0 +1,79 @@
+#include "uLogger.hpp"
+#include "uLoggerShmRing.hpp"
+#include "RegressionCheck.hpp"
+
+/**
+ * A reader following a shared-memory ring that the producer overruns gets
+ * increasing record indexes and whole messages, and every record written
+ * is either read or counted as lost.
+ */
+
+static constexpr int RECORDS = 20000;
+
+static std::string payload(int i)
+{
+    return std::string(static_cast<size_t>(10 + i % 50), static_cast<char>('a' + i % 26));
+}
+
+int main()
+{
+    const std::string name = "regression." + std::to_string(::getpid());
+    auto logger = std::make_shared<LogBuffer>();
+    setLogger(logger);
+    LOG_INIT(LOG_FIXED, LOG_FIXED, false, false, false);
+    auto sink = std::make_shared<ShmRingSink>(name, 4096);
+    CHECK(sink->isOpen());
+    log_local->addSink(sink);
+
+    shmlog::Reader reader;
+    CHECK(reader.open(name));
+    std::atomic<bool> done {false};
+    uint64_t read = 0;
+    uint64_t torn = 0;
+    uint64_t outOfOrder = 0;
+
+    std::thread follower([&] {
+        shmlog::Record record;
+        bool first = true;
+        uint64_t previous = 0;
+        for (;;) {
+            bool finished = done.load();
+            while (reader.next(record)) {
+                if (!first && record.index <= previous) {
+                    ++outOfOrder;
+                }
+                first = false;
+                previous = record.index;
+                int i = -1;
+                char text[64] = {};
+                if (std::sscanf(record.message.c_str(), "record %d %63s", &i, text) != 2 ||
+                    static_cast<uint64_t>(i) != record.index || text != payload(i)) {
+                    ++torn;
+                }
+                // A slow reader, so the producer laps it
+                if (++read % 64 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+            if (finished) break;
+            std::this_thread::yield();
+        }
+    });
+
+    for (int i = 0; i < RECORDS; ++i) {
+        LOG_PRINT(LOG_INFO, LOG_STRING("record"); LOG_INT(i); LOG_STRING(payload(i)));
+    }
+    done.store(true);
+    follower.join();
+
+    CHECK(outOfOrder == 0);
+    CHECK(torn == 0);
+    CHECK(reader.lost > 0);
+    CHECK(reader.lost + read == RECORDS);
+
+    log_local->removeSink(sink);
+    sink.reset();
+    CHECK(reader.isClosed());
+    ::shm_unlink(shmlog::objectName(name).c_str());
+    return regressionFailures;
+}
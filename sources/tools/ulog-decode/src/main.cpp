@@ -0,0 +1,323 @@
+#include "uLogger.hpp"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+/**
+ * @brief Writes decoded data to the output, rendering binary logs as text.
+ *
+ * The format is detected from the first bytes: a binary log header selects
+ * the record renderer, anything else is copied through unchanged. With
+ * filterText, text lines are kept by the timestamp they start with; lines
+ * without one belong to the record before them.
+ */
+struct Renderer
+{
+    std::FILE* out;
+    std::string head;
+    bool detected = false;
+    bool binary = false;
+    binlog::StreamDecoder decoder;
+    std::string line;
+    uint64_t records = 0;
+    bool badArgs = false;
+    int64_t fromMicros = INT64_MIN;
+    int64_t toMicros = INT64_MAX;
+    bool filterText = false;
+    bool undated = false;        // text timestamps without a date, which no window can match
+    std::string pendingText;     // text after the last complete line
+    bool keepLine = false;
+    std::string stampSecond;     // "YYYY-MM-DD HH:MM:SS" of the last parsed timestamp
+    int64_t stampSecondMicros = 0;
+
+    explicit Renderer(std::FILE* output)
+        : out(output)
+    {
+    }
+
+    void write(const char* data, size_t size)
+    {
+        if (!detected) {
+            head.append(data, size);
+            if (head.size() < binlog::HEADER_SIZE) return;
+            detect();
+            return;
+        }
+        if (!binary) {
+            if (filterText) {
+                filterLines(data, size);
+            } else {
+                std::fwrite(data, 1, size, out);
+            }
+            return;
+        }
+        decoder.feed(data, size);
+        render();
+    }
+
+    void finish()
+    {
+        if (!detected) {
+            detect();
+        }
+        if (!pendingText.empty()) {
+            // The last line has no newline
+            filterLine(pendingText);
+            pendingText.clear();
+        }
+    }
+
+private:
+    void detect()
+    {
+        detected = true;
+        binary = binlog::isBinaryLog(head.data(), head.size());
+        std::string pending;
+        pending.swap(head);
+        write(pending.data(), pending.size());
+    }
+
+    void filterLines(const char* data, size_t size)
+    {
+        pendingText.append(data, size);
+        size_t start = 0;
+        size_t newline;
+        while ((newline = pendingText.find('\n', start)) != std::string::npos) {
+            line.assign(pendingText, start, newline + 1 - start);
+            filterLine(line);
+            start = newline + 1;
+        }
+        pendingText.erase(0, start);
+    }
+
+    void filterLine(const std::string& text)
+    {
+        if (undated) return;
+        int64_t micros;
+        if (parseStamp(text, micros)) {
+            keepLine = micros >= fromMicros && micros <= toMicros;
+        }
+        if (keepLine) {
+            std::fwrite(text.data(), 1, text.size(), out);
+        }
+    }
+
+    /**
+     * @brief Reads the "YYYY-MM-DD HH:MM:SS.micros | " prefix of a text record (local time).
+     */
+    bool parseStamp(const std::string& text, int64_t& micros)
+    {
+        int fraction = 0;
+        int used = 0;
+        std::tm tm {};
+        if (std::sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d:%2d.%6d |%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                        &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &fraction, &used) != 7 || used == 0) {
+            if (std::sscanf(text.c_str(), "%2d:%2d:%2d.%6d |%n", &tm.tm_hour, &tm.tm_min, &tm.tm_sec,
+                            &fraction, &used) == 4 && used > 0) {
+                undated = true;
+            }
+            return false;
+        }
+        // mktime() is slow; records of the same second share its result
+        if (text.compare(0, 19, stampSecond) != 0) {
+            tm.tm_year -= 1900;
+            tm.tm_mon -= 1;
+            tm.tm_isdst = -1;
+            stampSecond.assign(text, 0, 19);
+            stampSecondMicros = static_cast<int64_t>(std::mktime(&tm)) * 1'000'000;
+        }
+        micros = stampSecondMicros + fraction;
+        return true;
+    }
+
+    void render()
+    {
+        binlog::Record record;
+        while (decoder.next(record)) {
+            if (record.micros < fromMicros || record.micros > toMicros) continue;
+            auto micros = std::chrono::microseconds(record.micros);
+            line = LogBuffer::formatTimestamp(std::chrono::system_clock::time_point(micros), decoder.includeDate);
+            line += toString(static_cast<LogLevel>(record.level));
+            line += " | ";
+            if (!binlog::renderArgs(record.args, record.argsSize, line)) {
+                badArgs = true;
+            }
+            if (record.truncated) {
+                line += " [TRUNCATED]";
+            }
+            line += "\n";
+            std::fwrite(line.data(), 1, line.size(), out);
+            ++records;
+        }
+    }
+};
+
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: ulog-decode [--from TIME] [--to TIME] <file> [output]\n");
+    std::fprintf(stderr, "  Renders a binary log (.ulog) as text and decompresses block-compressed\n");
+    std::fprintf(stderr, "  files (.lz4); plain text is copied through. Writes to stdout by default.\n");
+    std::fprintf(stderr, "  A file cut short by a crash is decoded up to its last complete record.\n");
+    std::fprintf(stderr, "  --from/--to select a time window (\"YYYY-MM-DD HH:MM:SS\" local time or\n");
+    std::fprintf(stderr, "  epoch seconds); the sidecar <file>.idx is used to seek to it. Records\n");
+    std::fprintf(stderr, "  are filtered by their timestamps; text must have been written with dates.\n");
+}
+
+
+/**
+ * @brief Parses "YYYY-MM-DD HH:MM:SS" (local time) or epoch seconds into microseconds.
+ */
+static bool parseTime(const char* text, int64_t& micros)
+{
+    std::tm tm {};
+    char* end = nullptr;
+    if (std::sscanf(text, "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                    &tm.tm_hour, &tm.tm_min, &tm.tm_sec) == 6) {
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        micros = static_cast<int64_t>(std::mktime(&tm)) * 1'000'000;
+        return true;
+    }
+    long long seconds = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0') return false;
+    micros = static_cast<int64_t>(seconds) * 1'000'000;
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int64_t fromMicros = INT64_MIN;
+    int64_t toMicros = INT64_MAX;
+    bool window = false;
+    int arg = 1;
+    for (; arg + 1 < argc && (0 == std::strcmp(argv[arg], "--from") || 0 == std::strcmp(argv[arg], "--to")); arg += 2) {
+        bool from = 0 == std::strcmp(argv[arg], "--from");
+        int64_t& bound = from ? fromMicros : toMicros;
+        if (!parseTime(argv[arg + 1], bound)) {
+            std::fprintf(stderr, "ulog-decode: bad time %s\n", argv[arg + 1]);
+            return 2;
+        }
+        if (!from) {
+            // --to includes the whole second it names
+            bound += 999'999;
+        }
+        window = true;
+    }
+
+    int files = argc - arg;
+    if (files < 1 || files > 2 || 0 == std::strcmp(argv[arg], "-h") || 0 == std::strcmp(argv[arg], "--help")) {
+        usage();
+        return 2;
+    }
+    const char* inputPath = argv[arg];
+    const char* outputPath = (files == 2) ? argv[arg + 1] : nullptr;
+
+    std::FILE* in = std::fopen(inputPath, "rb");
+    if (!in) {
+        std::fprintf(stderr, "ulog-decode: cannot open %s\n", inputPath);
+        return 1;
+    }
+
+    std::FILE* out = outputPath ? std::fopen(outputPath, "wb") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "ulog-decode: cannot create %s\n", outputPath);
+        std::fclose(in);
+        return 1;
+    }
+
+    Renderer renderer(out);
+    renderer.fromMicros = fromMicros;
+    renderer.toMicros = toMicros;
+    renderer.filterText = window;
+    auto output = [&renderer](const char* data, size_t size) {
+        renderer.write(data, size);
+    };
+
+    uint8_t magic[sizeof(RING_MAGIC)] = {};
+    size_t magicSize = std::fread(magic, 1, sizeof(magic), in);
+    bool framed = magicSize >= 4 && lz4::readLE32(magic) == lz4::FRAME_MAGIC;
+    bool ring = magicSize == sizeof(RING_MAGIC) && 0 == std::memcmp(magic, RING_MAGIC, sizeof(RING_MAGIC));
+    std::rewind(in);
+
+    lz4::FrameReadResult result;
+    bool ringDamaged = false;
+    if (ring) {
+        // The oldest records may predate the first surviving binary header; those are skipped
+        RingHeader header {};
+        std::fread(&header, sizeof(header), 1, in);
+        std::rewind(in);
+        renderer.detected = true;
+        renderer.binary = (header.flags & RING_BINARY) != 0;
+        renderer.decoder.skipUntilHeader = true;
+        ringDamaged = !readRingFile(in, output, header);
+    } else if (framed) {
+        result = lz4::decompressFrames(in, output);
+    } else {
+        uint64_t begin = 0;
+        uint64_t end = UINT64_MAX;
+        std::vector<logindex::Entry> entries;
+        if (window && logindex::readIndex(logindex::indexPath(inputPath), entries)) {
+            begin = logindex::seekOffset(entries, fromMicros);
+            end = logindex::endOffset(entries, toMicros);
+        } else if (window) {
+            std::fprintf(stderr, "ulog-decode: no index for %s, scanning the whole file\n", inputPath);
+        }
+
+        if (begin > 0 && std::fseek(in, static_cast<long>(begin), SEEK_SET) != 0) {
+            begin = 0;
+        }
+        char chunk[1 << 16];
+        size_t got;
+        uint64_t position = begin;
+        while (position < end && (got = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+            got = static_cast<size_t>(std::min<uint64_t>(got, end - position));
+            output(chunk, got);
+            position += got;
+        }
+    }
+    renderer.finish();
+
+    std::fclose(in);
+    if (out != stdout) {
+        std::fclose(out);
+    } else {
+        std::fflush(stdout);
+    }
+
+    if (renderer.decoder.skipped > 0) {
+        std::fprintf(stderr, "ulog-decode: skipped %llu records older than the first binary header in the ring\n",
+                     static_cast<unsigned long long>(renderer.decoder.skipped));
+    }
+    if (renderer.undated) {
+        std::fprintf(stderr, "ulog-decode: %s has timestamps without dates; --from/--to cannot select from it\n",
+                     inputPath);
+        return 1;
+    }
+    if (ringDamaged) {
+        std::fprintf(stderr, "ulog-decode: damaged ring file\n");
+        return 1;
+    }
+    if (result.corrupt || renderer.decoder.corrupt) {
+        std::fprintf(stderr, "ulog-decode: corrupt data after %llu %s\n",
+                     static_cast<unsigned long long>(renderer.binary ? renderer.records : result.frames),
+                     renderer.binary ? "records" : "frames");
+        return 1;
+    }
+    if (renderer.badArgs) {
+        std::fprintf(stderr, "ulog-decode: some records had malformed arguments\n");
+    }
+    if (result.truncated) {
+        std::fprintf(stderr, "ulog-decode: file ends inside a frame; recovered %llu frames\n",
+                     static_cast<unsigned long long>(result.frames));
+    } else if (renderer.binary && renderer.decoder.hasPartial()) {
+        std::fprintf(stderr, "ulog-decode: file ends inside a record; recovered %llu records\n",
+                     static_cast<unsigned long long>(renderer.records));
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "uLoggerNetSink.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+/**
+ * @brief Prints every frame of @p reader as a log line, tagged with its sender.
+ */
+static void render(netlog::FrameReader& reader, const std::string& peer, std::string& line)
+{
+    netlog::Frame frame;
+    while (reader.next(frame)) {
+        auto micros = std::chrono::microseconds(frame.micros);
+        line = LogBuffer::formatTimestamp(std::chrono::system_clock::time_point(micros), true);
+        line += toString(static_cast<LogLevel>(frame.level));
+        line += " | ";
+        line.append(frame.message.data(), frame.message.size());
+        if (frame.truncated) {
+            line += " [TRUNCATED]";
+        }
+        if (!peer.empty()) {
+            line += "  <" + peer + ">";
+        }
+        line += "\n";
+        std::fwrite(line.data(), 1, line.size(), stdout);
+    }
+}
+
+static std::string peerName(const sockaddr_storage& address)
+{
+    char host[INET6_ADDRSTRLEN] = {};
+    uint16_t port = 0;
+    if (address.ss_family == AF_INET) {
+        auto* in = reinterpret_cast<const sockaddr_in*>(&address);
+        ::inet_ntop(AF_INET, &in->sin_addr, host, sizeof(host));
+        port = ntohs(in->sin_port);
+    } else if (address.ss_family == AF_INET6) {
+        auto* in = reinterpret_cast<const sockaddr_in6*>(&address);
+        ::inet_ntop(AF_INET6, &in->sin6_addr, host, sizeof(host));
+        port = ntohs(in->sin6_port);
+    }
+    return std::string(host) + ":" + std::to_string(port);
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: ulog-recv [--udp] [--bind ADDRESS] [--peer] <port>\n");
+    std::fprintf(stderr, "  Receives records from NetworkSink and prints them as log lines on stdout.\n");
+    std::fprintf(stderr, "  Listens on 127.0.0.1 over TCP unless told otherwise; --peer appends the\n");
+    std::fprintf(stderr, "  sender's address to each line.\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+    bool udp = false;
+    bool showPeer = false;
+    const char* bindAddress = "127.0.0.1";
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; ++arg) {
+        if (0 == std::strcmp(argv[arg], "--udp")) {
+            udp = true;
+        } else if (0 == std::strcmp(argv[arg], "--peer")) {
+            showPeer = true;
+        } else if (0 == std::strcmp(argv[arg], "--bind") && arg + 1 < argc) {
+            bindAddress = argv[++arg];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (arg + 1 != argc) {
+        usage();
+        return 2;
+    }
+    int port = std::atoi(argv[arg]);
+
+    sockaddr_storage address {};
+    socklen_t addressSize;
+    auto* in4 = reinterpret_cast<sockaddr_in*>(&address);
+    auto* in6 = reinterpret_cast<sockaddr_in6*>(&address);
+    if (::inet_pton(AF_INET, bindAddress, &in4->sin_addr) == 1) {
+        in4->sin_family = AF_INET;
+        in4->sin_port = htons(static_cast<uint16_t>(port));
+        addressSize = sizeof(sockaddr_in);
+    } else if (::inet_pton(AF_INET6, bindAddress, &in6->sin6_addr) == 1) {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(static_cast<uint16_t>(port));
+        addressSize = sizeof(sockaddr_in6);
+    } else {
+        std::fprintf(stderr, "ulog-recv: bad address %s\n", bindAddress);
+        return 2;
+    }
+
+    int listener = ::socket(address.ss_family, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    int on = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), addressSize) != 0 ||
+        (!udp && ::listen(listener, 16) != 0)) {
+        std::fprintf(stderr, "ulog-recv: cannot listen on %s:%d: %s\n", bindAddress, port, std::strerror(errno));
+        return 1;
+    }
+
+    std::string line;
+    std::vector<char> chunk(1 << 16);
+    if (udp) {
+        for (;;) {
+            sockaddr_storage sender {};
+            socklen_t senderSize = sizeof(sender);
+            ssize_t got = ::recvfrom(listener, chunk.data(), chunk.size(), 0,
+                                     reinterpret_cast<sockaddr*>(&sender), &senderSize);
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            // Every datagram stands alone
+            netlog::FrameReader reader;
+            reader.feed(chunk.data(), static_cast<size_t>(got));
+            render(reader, showPeer ? peerName(sender) : std::string(), line);
+            if (reader.corrupt) {
+                std::fprintf(stderr, "ulog-recv: malformed datagram from %s\n", peerName(sender).c_str());
+            }
+            std::fflush(stdout);
+        }
+        return 0;
+    }
+
+    struct Connection {
+        std::string peer;
+        netlog::FrameReader reader;
+    };
+    std::map<int, Connection> connections;
+    std::vector<pollfd> waiters;
+    for (;;) {
+        waiters.assign(1, {listener, POLLIN, 0});
+        for (const auto& [fd, connection] : connections) {
+            waiters.push_back({fd, POLLIN, 0});
+        }
+        if (::poll(waiters.data(), waiters.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (size_t i = 1; i < waiters.size(); ++i) {
+            if (waiters[i].revents == 0) continue;
+            int fd = waiters[i].fd;
+            Connection& connection = connections[fd];
+            ssize_t got = ::recv(fd, chunk.data(), chunk.size(), 0);
+            if (got > 0) {
+                connection.reader.feed(chunk.data(), static_cast<size_t>(got));
+                render(connection.reader, showPeer ? connection.peer : std::string(), line);
+            }
+            if (got <= 0 || connection.reader.corrupt) {
+                if (connection.reader.corrupt) {
+                    std::fprintf(stderr, "ulog-recv: malformed stream from %s\n", connection.peer.c_str());
+                }
+                ::close(fd);
+                connections.erase(fd);
+            }
+        }
+        std::fflush(stdout);
+
+        if (waiters[0].revents & POLLIN) {
+            sockaddr_storage peer {};
+            socklen_t peerSize = sizeof(peer);
+            int fd = ::accept(listener, reinterpret_cast<sockaddr*>(&peer), &peerSize);
+            if (fd >= 0) {
+                connections[fd].peer = peerName(peer);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "uLoggerShmRing.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: ulog-shm [--follow] [--new] <name>\n");
+    std::fprintf(stderr, "  Prints the records of the shared-memory ring <name> (see ShmRingSink) as\n");
+    std::fprintf(stderr, "  log lines. --follow keeps printing new records, and moves on to a new ring\n");
+    std::fprintf(stderr, "  published under the same name; --new skips the records already there.\n");
+}
+
+
+static void print(const shmlog::Record& record, std::string& line)
+{
+    auto micros = std::chrono::microseconds(record.micros);
+    line = LogBuffer::formatTimestamp(std::chrono::system_clock::time_point(micros), true);
+    line += toString(static_cast<LogLevel>(record.level));
+    line += " | ";
+    line += record.message;
+    if (record.truncated) {
+        line += " [TRUNCATED]";
+    }
+    line += "\n";
+    std::fwrite(line.data(), 1, line.size(), stdout);
+}
+
+
+int main(int argc, char* argv[])
+{
+    bool follow = false;
+    bool onlyNew = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; ++arg) {
+        if (0 == std::strcmp(argv[arg], "--follow")) {
+            follow = true;
+        } else if (0 == std::strcmp(argv[arg], "--new")) {
+            onlyNew = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (arg + 1 != argc) {
+        usage();
+        return 2;
+    }
+    std::string name = argv[arg];
+
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(10);
+    constexpr auto REPLACE_CHECK_INTERVAL = std::chrono::milliseconds(500);
+
+    shmlog::Reader reader;
+    if (!reader.open(name)) {
+        if (!follow) {
+            std::fprintf(stderr, "ulog-shm: no ring named %s\n", name.c_str());
+            return 1;
+        }
+        while (!reader.open(name)) {
+            std::this_thread::sleep_for(REPLACE_CHECK_INTERVAL);
+        }
+    }
+    if (onlyNew) {
+        reader.skipToEnd();
+    }
+
+    std::string line;
+    shmlog::Record record;
+    uint64_t lost = 0;
+    auto nextReplaceCheck = std::chrono::steady_clock::now() + REPLACE_CHECK_INTERVAL;
+    for (;;) {
+        bool any = false;
+        while (reader.next(record)) {
+            print(record, line);
+            any = true;
+        }
+        if (any) {
+            std::fflush(stdout);
+        }
+        if (!follow) break;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextReplaceCheck) {
+            nextReplaceCheck = now + REPLACE_CHECK_INTERVAL;
+            if (reader.isReplaced(name)) {
+                // Everything the old producer published was printed above
+                lost += reader.lost;
+                reader.open(name);
+                continue;
+            }
+        }
+        if (!any) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+
+    lost += reader.lost;
+    if (lost > 0) {
+        std::fprintf(stderr, "ulog-shm: %llu records were overwritten before they could be read\n",
+                     static_cast<unsigned long long>(lost));
+    }
+    return 0;
+}
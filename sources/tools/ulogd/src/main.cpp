@@ -0,0 +1,225 @@
+#include "uLoggerShmRing.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+
+#include <sys/types.h>
+
+
+/**
+ * @brief A process attached through its shared-memory ring.
+ */
+struct Source
+{
+    std::string name;        // ring name without the "ulog." object prefix
+    std::string label;       // "[name] ", put in front of every message
+    uint32_t id = 0;
+    shmlog::Reader reader;
+    uint64_t reportedLost = 0;
+};
+
+/**
+ * @brief A record waiting in the merge window.
+ */
+struct Pending
+{
+    int64_t micros;
+    uint32_t source;
+    uint64_t sequence;
+    uint8_t level;
+    bool truncated;
+    std::string message;
+
+    bool operator>(const Pending& other) const
+    {
+        if (micros != other.micros) return micros > other.micros;
+        if (source != other.source) return source > other.source;
+        return sequence > other.sequence;
+    }
+};
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: ulogd [options] <prefix>\n");
+    std::fprintf(stderr, "  Merges the shared-memory rings /dev/shm/ulog.<prefix>* of many processes\n");
+    std::fprintf(stderr, "  (see ShmRingSink) by timestamp and sequence number into one log file.\n");
+    std::fprintf(stderr, "  --file PATH      output file (default: log_<time>.txt in the current directory)\n");
+    std::fprintf(stderr, "  --rotate BYTES   rotate the output at this size\n");
+    std::fprintf(stderr, "  --files N        keep at most N segments\n");
+    std::fprintf(stderr, "  --binary         write the binary log format\n");
+    std::fprintf(stderr, "  --compress       compress the output with streaming LZ4\n");
+    std::fprintf(stderr, "  --delay MS       merge window: how long records wait for older ones (default 100)\n");
+    std::fprintf(stderr, "  --once           merge what the rings hold now and exit\n");
+    std::fprintf(stderr, "  SIGHUP reopens the output file; SIGINT and SIGTERM drain the rings and exit.\n");
+}
+
+static bool producerGone(const shmlog::Reader& reader)
+{
+    if (reader.isClosed()) return true;
+    pid_t pid = static_cast<pid_t>(reader.header->producerPid);
+    return ::kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string file;
+    size_t rotateBytes = 0;
+    size_t maxFiles = 0;
+    bool binary = false;
+    bool compress = false;
+    bool once = false;
+    auto delay = std::chrono::milliseconds(100);
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; ++arg) {
+        bool hasValue = arg + 1 < argc;
+        if (0 == std::strcmp(argv[arg], "--file") && hasValue) {
+            file = argv[++arg];
+        } else if (0 == std::strcmp(argv[arg], "--rotate") && hasValue) {
+            rotateBytes = std::strtoull(argv[++arg], nullptr, 10);
+        } else if (0 == std::strcmp(argv[arg], "--files") && hasValue) {
+            maxFiles = std::strtoull(argv[++arg], nullptr, 10);
+        } else if (0 == std::strcmp(argv[arg], "--delay") && hasValue) {
+            delay = std::chrono::milliseconds(std::strtoll(argv[++arg], nullptr, 10));
+        } else if (0 == std::strcmp(argv[arg], "--binary")) {
+            binary = true;
+        } else if (0 == std::strcmp(argv[arg], "--compress")) {
+            compress = true;
+        } else if (0 == std::strcmp(argv[arg], "--once")) {
+            once = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (arg + 1 != argc) {
+        usage();
+        return 2;
+    }
+    const std::string objectPrefix = "ulog." + std::string(argv[arg]);
+
+    // One writer for every process: batched blocks, flushed on errors and at least once a second
+    auto output = std::make_shared<LogBuffer>();
+    output->useColors = false;
+    output->setConsoleThreshold(LOG_FIXED);
+    output->setFileThreshold(LOG_VERBOSE);
+    output->setFlushPolicy(FlushPolicy::ERROR_AND_ABOVE | FlushPolicy::INTERVAL | FlushPolicy::BYTES);
+    output->setFileFormat(binary ? LogFileFormat::BINARY : LogFileFormat::TEXT);
+    output->setFileBlockCompression(compress);
+    if (rotateBytes > 0) {
+        output->setFileRotation(rotateBytes, maxFiles);
+    }
+    output->enableFileLogging(file);
+    if (!output->fileLoggingEnabled) {
+        std::fprintf(stderr, "ulogd: cannot open the output file\n");
+        return 1;
+    }
+    output->enableReopenOnSignal(SIGHUP);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    constexpr auto SCAN_INTERVAL = std::chrono::milliseconds(200);
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(5);
+    constexpr size_t READ_BATCH = 4096;
+
+    std::vector<std::unique_ptr<Source>> sources;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> window;
+    uint32_t nextSourceId = 0;
+    auto nextScan = std::chrono::steady_clock::time_point();
+    shmlog::Record record;
+
+    auto scan = [&] {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", ec)) {
+            std::string object = entry.path().filename().string();
+            if (object.compare(0, objectPrefix.size(), objectPrefix) != 0) continue;
+            std::string name = "/" + object;
+            bool known = false;
+            for (const auto& source : sources) {
+                known = known || (source->name == name && !source->reader.isReplaced(name));
+            }
+            if (known) continue;
+            auto source = std::make_unique<Source>();
+            if (!source->reader.open(name)) continue;
+            source->name = name;
+            source->label = "[" + object.substr(5) + "]";
+            source->id = nextSourceId++;
+            sources.push_back(std::move(source));
+        }
+    };
+
+    bool draining = once;
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextScan) {
+            scan();
+            nextScan = now + SCAN_INTERVAL;
+        }
+
+        bool any = false;
+        int64_t horizon = std::chrono::duration_cast<std::chrono::microseconds>(
+            (std::chrono::system_clock::now() - delay).time_since_epoch()).count();
+        for (auto it = sources.begin(); it != sources.end();) {
+            Source& source = **it;
+            // Check before reading, so a ring is only retired once everything it published was read
+            bool gone = producerGone(source.reader);
+            size_t taken = 0;
+            while (taken < READ_BATCH && source.reader.next(record)) {
+                window.push({record.micros, source.id, record.sequence, record.level, record.truncated,
+                             source.label + " " + record.message});
+                ++taken;
+            }
+            any = any || taken > 0;
+            if (taken == READ_BATCH) {
+                // Still behind: its unread records may be older than what the others have given
+                horizon = std::min(horizon, record.micros);
+            }
+
+            if (source.reader.lost > source.reportedLost) {
+                std::string note = source.label + " " + std::to_string(source.reader.lost - source.reportedLost) +
+                                   " records were overwritten before ulogd could read them";
+                output->printRecord(LOG_WARNING, std::chrono::system_clock::now(), note);
+                source.reportedLost = source.reader.lost;
+            }
+
+            if (gone && taken == 0) {
+                // Drained and the producer has gone: the ring is ours to remove
+                if (!source.reader.isReplaced(source.name)) {
+                    ::shm_unlink(source.name.c_str());
+                }
+                it = sources.erase(it);
+                continue;
+            }
+            ++it;
+        }
+
+        bool finishing = (draining || stopRequested) && !any;
+        while (!window.empty() && (finishing || window.top().micros <= horizon)) {
+            const Pending& top = window.top();
+            auto time = std::chrono::system_clock::time_point(std::chrono::microseconds(top.micros));
+            output->printRecord(static_cast<LogLevel>(top.level), time, top.message, top.truncated);
+            window.pop();
+        }
+
+        if (finishing) break;
+        if (!any) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+
+    output->flush();
+    output->disableFileLogging();
+    return 0;
+}
@@ -2,6 +2,7 @@
 #define ULOGGER_H
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -12,8 +13,32 @@
 #include <sstream>
 #include <fstream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <memory>
 #include <atomic>
+#include <deque>
+#include <vector>
+#include <string_view>
+#include <filesystem>
+#include <csignal>
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "uLoggerBinary.hpp"
+#include "uLoggerCodec.hpp"
+#include "uLoggerFileSink.hpp"
+#include "uLoggerFlightRecorder.hpp"
+#include "uLoggerIndex.hpp"
+#include "uLoggerSignalLog.hpp"
+#include "uLoggerWorker.hpp"
 
 /**
  * @brief Enumeration for log levels.
@@ -74,13 +99,225 @@ inline const char* getColor(LogLevel level)
 }
 
 /**
- * @brief Configuration for log flushing behavior.
+ * @brief Configuration for log flushing behavior; rules combine with operator|.
+ */
+enum class FlushPolicy : unsigned {
+    NEVER           = 0,       /**< Never auto-flush (manual flush only). */
+    ALWAYS          = 1 << 0,  /**< Flush after every log message. */
+    ERROR_AND_ABOVE = 1 << 1,  /**< Flush only for ERROR, FATAL, and FIXED levels. */
+    INTERVAL        = 1 << 2,  /**< Flush pending data at least every flush interval, from a timer. */
+    BYTES           = 1 << 3   /**< Flush once the flush byte threshold is pending. */
+};
+
+inline constexpr FlushPolicy operator|(FlushPolicy a, FlushPolicy b)
+{
+    return static_cast<FlushPolicy>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+/**
+ * @brief Returns true if @p policy includes @p rule.
+ */
+inline constexpr bool hasRule(FlushPolicy policy, FlushPolicy rule)
+{
+    return (static_cast<unsigned>(policy) & static_cast<unsigned>(rule)) != 0;
+}
+
+/**
+ * @brief Records whose caller waits until they are durable on disk.
+ */
+enum class DurabilityPolicy {
+    NONE,             /**< No record waits for the disk. */
+    ERROR_AND_ABOVE,  /**< ERROR, FATAL and FIXED records return once synced. */
+    ALWAYS            /**< Every file record returns once synced. */
+};
+
+/**
+ * @brief Period for time-based log file rotation.
+ */
+enum class RotationInterval {
+    NONE,             /**< No time-based rotation. */
+    HOURLY,           /**< New file at the start of every hour. */
+    DAILY             /**< New file at local midnight. */
+};
+
+/**
+ * @brief What a forked child does with the log file it inherited.
+ */
+enum class ForkFilePolicy {
+    SAME_FILE,        /**< Append to the same file; setting it moves the parent to FileIoMode::SHARED. */
+    PER_PROCESS,      /**< Write <name>_<pid>.<ext> instead (default); ring files always do, as a ring has one writer. */
+    CLOSE             /**< No file logging in the child. */
+};
+
+/**
+ * @brief On-disk format of the log file.
+ */
+enum class LogFileFormat {
+    TEXT,             /**< Formatted text lines. */
+    BINARY            /**< Compact binary records, rendered to text by ulog-decode. */
+};
+
+/**
+ * @brief Limits on the rotated log files kept on disk; 0 disables a limit.
+ */
+struct RetentionPolicy {
+    uint64_t maxTotalBytes = 0;          /**< Budget for all segments, including the live one. */
+    std::chrono::seconds maxAge {0};     /**< Delete segments closed longer ago than this. */
+    size_t maxFiles = 0;                 /**< Segments kept, including the live one. */
+};
+
+/**
+ * @brief A closed log segment tracked for retention.
+ */
+struct LogSegment {
+    std::string path;
+    std::string index;    // sidecar time index, if one was written
+    uint64_t bytes = 0;
+    std::chrono::system_clock::time_point closedAt;
+};
+
+/**
+ * @brief Outcome of a shutdown with a deadline.
+ */
+struct ShutdownReport {
+    bool complete = true;          /**< Everything pending was written or delivered before the deadline. */
+    uint64_t droppedRecords = 0;   /**< Records given up on when the deadline passed. */
+};
+
+/**
+ * @brief Flight recorder entries copied out under the logger's lock, rendered and written without it.
+ */
+struct FlightDump {
+    std::string path;
+    bool includeDate = true;
+    std::unique_ptr<FlightRecorder> entries;
+};
+
+/**
+ * @brief What is left of a record once the logger's lock is released; see LogBuffer::completePrint().
+ */
+struct PrintTicket {
+    uint64_t durable = 0;                     /**< Ticket for LogBuffer::waitDurable(), or 0. */
+    std::unique_ptr<FlightDump> flightDump;   /**< Dump due for a FATAL record, or null. */
+};
+
+/**
+ * @brief A record as handed to record sinks; @p message is only valid during the call.
+ */
+struct LogRecord {
+    LogLevel level;
+    uint64_t sequence;
+    std::chrono::system_clock::time_point time;
+    std::string_view message;   // formatted arguments, without timestamp and level
+    bool truncated;
+};
+
+/**
+ * @brief Destination that takes whole records rather than formatted lines.
+ *
+ * consume() is called with the logger lock held, so it must hand the record
+ * off without blocking; AsyncRecordSink does that with a queue and a thread.
+ */
+struct RecordSink {
+    virtual ~RecordSink() = default;
+    virtual void consume(const LogRecord& record) = 0;
+    virtual void flush() {}
+
+    /**
+     * @brief Delivers what the sink still holds and stops it, giving up at @p deadline.
+     *
+     * A sink that reports itself incomplete may still have a thread inside
+     * it; the logger then keeps it alive rather than have it joined.
+     */
+    virtual ShutdownReport shutdown(std::chrono::steady_clock::time_point deadline)
+    {
+        (void)deadline;
+        flush();
+        return {};
+    }
+
+    /**
+     * @brief Takes the locks the sink's own threads use, before fork().
+     */
+    virtual void prepareFork() {}
+
+    /**
+     * @brief Releases what prepareFork() took, in the parent.
+     */
+    virtual void parentAfterFork() {}
+
+    /**
+     * @brief Releases what prepareFork() took in the child, whose copy of the sink has no threads.
+     */
+    virtual void childAfterFork() {}
+};
+
+/**
+ * @brief Count of reopen signals received; loggers compare it with the last value they handled.
+ */
+inline std::atomic<unsigned> reopenSignals {0};
+
+/**
+ * @brief Signal handler for the reopen hook: only bumps the counter (async-signal-safe).
+ */
+inline void reopenSignalHandler(int)
+{
+    reopenSignals.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct LogBuffer;
+
+/**
+ * @brief Every live LogBuffer, for process-wide hooks such as the fork handlers.
+ */
+inline std::mutex loggerRegistryMutex;
+inline std::vector<LogBuffer*> loggerRegistry;
+
+inline void registerLogger(LogBuffer* logger);
+inline void unregisterLogger(LogBuffer* logger);
+
+#ifndef _WIN32
+/**
+ * @brief Logger that drains its file and dumps its flight recorder when the process crashes.
+ */
+inline std::atomic<LogBuffer*> crashLogger {nullptr};
+
+inline constexpr int CRASH_SIGNALS[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+inline struct sigaction crashPreviousActions[std::size(CRASH_SIGNALS)];
+
+inline void crashSignalHandler(int signal, siginfo_t* info, void* context);
+
+/**
+ * @brief Alternate signal stack of one thread, so the crash handler can run after a stack overflow.
  */
-enum class FlushPolicy {
-    ALWAYS,           /**< Flush after every log message. */
-    ERROR_AND_ABOVE,  /**< Flush only for ERROR, FATAL, and FIXED levels. */
-    NEVER             /**< Never auto-flush (manual flush only). */
+struct CrashSignalStack
+{
+    std::unique_ptr<char[]> memory;
+
+    CrashSignalStack()
+    {
+        stack_t current;
+        // A stack the application installed is left in place
+        if (::sigaltstack(nullptr, &current) == 0 && !(current.ss_flags & SS_DISABLE)) return;
+        size_t size = std::max<size_t>(SIGSTKSZ, 64 * 1024);
+        memory.reset(new char[size]);
+        stack_t stack {};
+        stack.ss_sp = memory.get();
+        stack.ss_size = size;
+        if (::sigaltstack(&stack, nullptr) != 0) {
+            memory.reset();
+        }
+    }
+
+    ~CrashSignalStack()
+    {
+        if (!memory) return;
+        stack_t stack {};
+        stack.ss_flags = SS_DISABLE;
+        ::sigaltstack(&stack, nullptr);
+    }
 };
+#endif
 
 /**
  * @brief Structure for log buffer with improved performance and thread safety.
@@ -95,7 +332,8 @@ struct LogBuffer
     LogLevel consoleThreshold = LOG_VERBOSE;
     LogLevel fileThreshold = LOG_VERBOSE;
 
-    std::ofstream logFile;
+    std::unique_ptr<FileSink> logFile;
+    FileSinkOptions fileOptions;
     mutable std::mutex logMutex;  // Made mutable for const methods
 
     bool fileLoggingEnabled = false;
@@ -104,12 +342,139 @@ struct LogBuffer
     bool truncated = false;  // Flag to track if message was truncated
 
     FlushPolicy flushPolicy = FlushPolicy::ERROR_AND_ABOVE;
+    std::chrono::milliseconds flushInterval {1000};
+    size_t flushBytes = 64 * 1024;
+    size_t unflushedBytes = 0;      // written to the sink since its last flush
+    size_t unflushedRecords = 0;    // records among them
+    bool flushTimerArmed = false;
+
+    // Group commit: durable records share one fdatasync, issued outside logMutex by a leader
+    DurabilityPolicy durabilityPolicy = DurabilityPolicy::NONE;
+    std::chrono::microseconds groupCommitWindow {0};
+    uint64_t durableIssued = 0;     // tickets handed out (logMutex)
+    uint64_t durableCaptured = 0;   // tickets covered by a sync already under way (logMutex)
+    uint64_t durableSynced = 0;     // tickets known to be on disk (commitMutex)
+    bool commitLeader = false;      // a caller is running the sync (commitMutex)
+    std::mutex commitMutex;
+    std::condition_variable commitDone;
+
+    // Rotation (maxFileSize == 0 and RotationInterval::NONE disable it)
+    static constexpr auto ROTATION_PREOPEN_LEAD = std::chrono::seconds(2);
+    size_t maxFileSize = 0;
+    RotationInterval rotationInterval = RotationInterval::NONE;
+    std::string fileName;        // name given to enableFileLogging(), empty for log_<time>.txt
+    std::string filePath;        // base path of the current time period
+    std::string currentPath;     // path of the segment being written
+    size_t fileBytes = 0;
+    size_t segmentIndex = 0;
+    std::chrono::system_clock::time_point nextRotationTime;
+    std::unique_ptr<FileSink> nextFile;        // pre-opened size segment
+    std::unique_ptr<FileSink> nextTimedFile;   // pre-opened segment of the next period
+    std::string nextTimedPath;
+    bool nextFileRequested = false;
+    uint64_t fileGeneration = 0;
+
+    // Retention of closed segments; the list is only touched by the worker thread
+    static constexpr auto RETENTION_CHECK_INTERVAL = std::chrono::seconds(60);
+    RetentionPolicy retention;
+    bool retentionTimerArmed = false;
+    std::deque<LogSegment> retainedSegments;
+
+    CompressionCodec segmentCompression = CompressionCodec::NONE;
+    LogWorker compressor {true};   // Compresses rotated segments at idle priority
+
+    LogWorker worker;  // Opens, closes and deletes files off the hot path
+
+    // Reopen on signal (external logrotate); the worker polls the signal counter while file logging is on
+    static constexpr auto REOPEN_POLL_INTERVAL = std::chrono::milliseconds(200);
+    bool reopenOnSignal = false;
+    bool reopenPollArmed = false;
+    unsigned reopenSignalsSeen = 0;
+
+    // Binary file format; arguments are captured typed and only formatted when text is needed
+    LogFileFormat fileFormat = LogFileFormat::TEXT;
+    bool binaryFile = false;   // format of the file being written, fixed when it is opened
+    binlog::ArgBuffer<BUFFER_SIZE> args;
+    binlog::DeltaState binaryState;
+    std::string binaryRecord;
+    bool binaryHeaderPending = true;
+    bool captureArgs = false;
+    bool formatText = true;
+    uint64_t sequence = 0;
+
+    // Sidecar time index of the current file (0 disables); entries are appended by the worker
+    std::chrono::seconds indexInterval {0};
+    bool indexedFile = false;
+    int64_t nextIndexMicros = 0;
+
+    // Record sinks (syslog, network, ...), each with its own threshold
+    struct SinkEntry {
+        std::shared_ptr<RecordSink> sink;
+        LogLevel threshold;
+    };
+    std::vector<SinkEntry> recordSinks;
+    LogLevel sinkThreshold = LOG_FIXED;   // lowest threshold among recordSinks
+
+    // Flight recorder: every record, at every level, kept in binary form in memory
+    FlightRecorder flightRecorder;
+    std::string flightDumpPrefix = "flight";
+    char crashDumpPrefix[256] = "flight";   // copy of flightDumpPrefix the crash handler can read
+    bool crashFlightDump = false;
+
+    // Crash handler: drains the file backend and writes a marker record on a crash signal
+    bool crashDrain = false;
+    long signalUtcOffset = 0;   // seconds east of UTC, for timestamps formatted in signal handlers
+
+#ifndef _WIN32
+    // Async-signal-safe records (LOG_SIGNAL), drained into the regular outputs
+    static constexpr auto SIGNAL_LOG_POLL_INTERVAL = std::chrono::milliseconds(100);
+    SignalLog signalLog;
+    int signalEchoFd = -1;         // also written here at once, with write(2)
+    bool signalPollArmed = false;
+    bool drainingSignalLog = false;
+    uint64_t signalDropsReported = 0;
+#endif
+
+    // Backtrace: the last suppressed DEBUG/VERBOSE records, replayed before the next ERROR or FATAL
+    static constexpr const char* BACKTRACE_MARK = "[backtrace]";
+    struct BacktraceEntry {
+        LogLevel level;
+        uint64_t sequence;
+        std::chrono::system_clock::time_point time;
+        bool truncated;
+        std::string args;   // typed arguments, as for the binary format
+    };
+    std::vector<BacktraceEntry> backtrace;   // ring of backtraceLimit entries
+    size_t backtraceLimit = 0;
+    size_t backtraceStart = 0;               // oldest entry
+    size_t backtraceCount = 0;
+
+    ForkFilePolicy forkFilePolicy = ForkFilePolicy::PER_PROCESS;
+    bool fileOpenDeferred = false;   // forked child: its file is opened by its first file record
+
+    // Deadline for the shutdown at exit of the global logger; read without the lock, which a stuck writer may hold
+    static constexpr auto DEFAULT_SHUTDOWN_TIMEOUT = std::chrono::milliseconds(5000);
+    std::atomic<int64_t> exitShutdownMillis {DEFAULT_SHUTDOWN_TIMEOUT.count()};
+
+    bool ringFile = false;   // current file is a fixed-size ring: no rotation, no index
+    bool sharedFile = false; // other processes append to the current file
+    size_t ringHeaderSpacing = 0;
+    size_t nextRingHeaderBytes = 0;
 
     // Timestamp caching for performance
     mutable std::string cachedTimestamp;
     mutable std::chrono::system_clock::time_point lastTimestampUpdate;
     mutable std::mutex timestampMutex;
 
+    LogBuffer()
+    {
+        registerLogger(this);
+        fileOptions.background = [this](std::function<void()> task) { worker.post(std::move(task)); };
+    }
+
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
     /**
      * @brief Resets the log buffer.
      */
@@ -119,6 +484,31 @@ struct LogBuffer
         buffer[0] = '\0';
         currentLevel = LOG_INFO;
         truncated = false;
+        args.clear();
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Decides how arguments of the current record are captured.
+     *
+     * Text is formatted for the console, text files and record sinks; a
+     * record that only goes to a binary file, the flight recorder or the
+     * backtrace keeps its typed arguments and skips snprintf.
+     */
+    void updateCaptureFlags()
+    {
+        bool toFile = fileLoggingEnabled && currentLevel >= fileThreshold;
+        captureArgs = (toFile && binaryFile) || flightRecorder.isEnabled() ||
+                      (backtraceLimit > 0 && currentLevel <= LOG_DEBUG);
+        formatText = currentLevel >= consoleThreshold || (toFile && !binaryFile) || toSinks();
+    }
+
+    /**
+     * @brief Returns true if a record sink wants the current record.
+     */
+    bool toSinks() const
+    {
+        return !recordSinks.empty() && currentLevel >= sinkThreshold;
     }
 
     /**
@@ -146,6 +536,10 @@ struct LogBuffer
      */
     void append(char c)
     {
+        if (captureArgs) {
+            args.putByte(binlog::ArgTag::CHAR, static_cast<uint8_t>(c));
+        }
+        if (!formatText) return;
         if (size >= BUFFER_SIZE - 2) {
             truncated = true;
             return;
@@ -159,6 +553,10 @@ struct LogBuffer
      */
     void append(const char* text)
     {
+        if (captureArgs && nullptr != text) {
+            args.putString(text, std::strlen(text));
+        }
+        if (!formatText) return;
         if (nullptr == text || size >= BUFFER_SIZE - 1) {
             if (size >= BUFFER_SIZE - 1) truncated = true;
             return;
@@ -182,6 +580,10 @@ struct LogBuffer
      */
     void append(const std::string_view& text_view)
     {
+        if (captureArgs && !text_view.empty()) {
+            args.putString(text_view.data(), text_view.size());
+        }
+        if (!formatText) return;
         if (!text_view.empty()) {
             // Avoid creating temporary string for small views
             if (text_view.size() < BUFFER_SIZE - size - 1) {
@@ -199,6 +601,10 @@ struct LogBuffer
      */
     void append(bool value)
     {
+        if (captureArgs) {
+            args.putByte(binlog::ArgTag::BOOL, value ? 1 : 0);
+        }
+        if (!formatText) return;
         if (size >= BUFFER_SIZE - 10) {
             truncated = true;
             return;
@@ -214,6 +620,10 @@ struct LogBuffer
     typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type
     append(T value)
     {
+        if (captureArgs) {
+            args.putInteger(value, false);
+        }
+        if (!formatText) return;
         if (size >= BUFFER_SIZE - 25) {
             truncated = true;
             return;
@@ -236,6 +646,10 @@ struct LogBuffer
     typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type
     appendHex(T value)
     {
+        if (captureArgs) {
+            args.putInteger(value, true);
+        }
+        if (!formatText) return;
         if (size >= BUFFER_SIZE - 25) {
             truncated = true;
             return;
@@ -257,6 +671,10 @@ struct LogBuffer
     typename std::enable_if<std::is_floating_point<T>::value>::type
     append(T value)
     {
+        if (captureArgs) {
+            args.putFloat(value);
+        }
+        if (!formatText) return;
         if (size >= BUFFER_SIZE - 30) {
             truncated = true;
             return;
@@ -273,6 +691,10 @@ struct LogBuffer
     typename std::enable_if<std::is_pointer<T>::value>::type
     append(T ptr)
     {
+        if (captureArgs) {
+            args.putTagged(binlog::ArgTag::POINTER, reinterpret_cast<uintptr_t>(ptr));
+        }
+        if (!formatText) return;
         if (size >= BUFFER_SIZE - 20) {
             truncated = true;
             return;
@@ -286,20 +708,47 @@ struct LogBuffer
      * @brief Gets the current timestamp with caching for performance.
      */
     std::string getTimestamp() const
+    {
+        return getTimestamp(std::chrono::system_clock::now());
+    }
+
+    /**
+     * @brief Formats @p now, reusing the cached string within the same millisecond.
+     */
+    std::string getTimestamp(std::chrono::system_clock::time_point now) const
     {
         using namespace std::chrono;
-        auto now = system_clock::now();
         
         // Cache timestamp for 1ms to avoid excessive system calls
         {
             std::lock_guard<std::mutex> lock(timestampMutex);
             auto elapsed = duration_cast<milliseconds>(now - lastTimestampUpdate);
             
-            if (!cachedTimestamp.empty() && elapsed.count() < 1) {
+            // Records replayed through printRecord() may be older than the cached one
+            if (!cachedTimestamp.empty() && now >= lastTimestampUpdate && elapsed.count() < 1) {
                 return cachedTimestamp;
             }
         }
         
+        std::string result = formatTimestamp(now, includeDate);
+        
+        // Update cache
+        {
+            std::lock_guard<std::mutex> lock(timestampMutex);
+            cachedTimestamp = result;
+            lastTimestampUpdate = now;
+        }
+        
+        return result;
+    }
+
+    /**
+     * @brief Formats @p now as the "date time.micros | " record prefix.
+     */
+    static std::string formatTimestamp(std::chrono::system_clock::time_point now, bool withDate)
+    {
+        using namespace std::chrono;
+
         auto duration = now.time_since_epoch();
         auto micros = duration_cast<microseconds>(duration) % 1'000'000;
 
@@ -312,23 +761,13 @@ struct LogBuffer
 #endif
 
         std::ostringstream oss;
-        if (includeDate) {
+        if (withDate) {
             oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
         } else {
             oss << std::put_time(&tm, "%H:%M:%S");
         }
         oss << "." << std::setfill('0') << std::setw(6) << micros.count() << " | ";
-        
-        std::string result = oss.str();
-        
-        // Update cache
-        {
-            std::lock_guard<std::mutex> lock(timestampMutex);
-            cachedTimestamp = result;
-            lastTimestampUpdate = now;
-        }
-        
-        return result;
+        return oss.str();
     }
 
     /**
@@ -336,45 +775,109 @@ struct LogBuffer
      */
     bool shouldFlush() const
     {
-        switch (flushPolicy) {
-            case FlushPolicy::ALWAYS:
+        if (hasRule(flushPolicy, FlushPolicy::ALWAYS)) {
+            return true;
+        }
+        if (hasRule(flushPolicy, FlushPolicy::ERROR_AND_ABOVE) && currentLevel >= LOG_ERROR) {
+            return true;
+        }
+        return hasRule(flushPolicy, FlushPolicy::BYTES) && unflushedBytes >= flushBytes;
+    }
+
+    /**
+     * @brief Determines if the current record must be durable before its caller returns.
+     */
+    bool shouldSync() const
+    {
+        switch (durabilityPolicy) {
+            case DurabilityPolicy::ALWAYS:
                 return true;
-            case FlushPolicy::ERROR_AND_ABOVE:
+            case DurabilityPolicy::ERROR_AND_ABOVE:
                 return currentLevel >= LOG_ERROR;
-            case FlushPolicy::NEVER:
-                return false;
             default:
-                return true;
+                return false;
         }
     }
 
     /**
      * @brief Internal print without locking (called from locked context).
+     * @param now Timestamp of the record.
+     * @return Work to pass to completePrint() once the lock is released.
      */
-    void printUnsafe()
+    PrintTicket printUnsafe(std::chrono::system_clock::time_point now = std::chrono::system_clock::now())
     {
+#ifndef _WIN32
+        if (fileOpenDeferred && currentLevel >= fileThreshold) {
+            openDeferredFileUnsafe();
+        }
+#endif
+        bool toConsole = currentLevel >= consoleThreshold;
+        bool toFile = fileLoggingEnabled && currentLevel >= fileThreshold && logFile && logFile->isOpen();
+
+        bool sinks = toSinks();
+        ++sequence;
+        if (flightRecorder.isEnabled()) {
+            recordFlightUnsafe(now);
+        }
+
         // Early exit if log won't be written anywhere
-        if (currentLevel < consoleThreshold && 
-            (!fileLoggingEnabled || currentLevel < fileThreshold)) {
+        if (!toConsole && !toFile && !sinks) {
+            if (backtraceLimit > 0 && currentLevel <= LOG_DEBUG) {
+                keepBacktraceUnsafe(now);
+            }
             reset();
-            return;
+            return {};
         }
-        
-        std::string timestamp = getTimestamp();
-        const char* levelStr = toString(currentLevel);
-        
-        // Build message once
-        std::ostringstream oss;
-        oss << timestamp << levelStr << " | " << buffer;
-        if (truncated) {
-            oss << " [TRUNCATED]";
+
+        if (backtraceCount > 0 && (currentLevel == LOG_ERROR || currentLevel == LOG_FATAL)) {
+            replayBacktraceUnsafe(toConsole, toFile, sinks);
+        }
+        writeRecordUnsafe(now, toConsole, toFile, sinks, currentLevel);
+
+        PrintTicket ticket;
+        if (currentLevel == LOG_FATAL && flightRecorder.isEnabled()) {
+            // Copied while the ring still ends at this record; rendered and written by the caller
+            ticket.flightDump = captureFlightDumpUnsafe("");
+        }
+        if (toFile && shouldSync()) {
+            ticket.durable = ++durableIssued;
+        }
+        reset();
+#ifndef _WIN32
+        if (signalLog.hasPending()) {
+            drainSignalLogUnsafe();
+        }
+#endif
+        return ticket;
+    }
+
+    /**
+     * @brief Writes the current record to the outputs chosen by printUnsafe().
+     * @param sinkLevel Level the sink thresholds are compared with.
+     */
+    void writeRecordUnsafe(std::chrono::system_clock::time_point now, bool toConsole, bool toFile, bool sinks,
+                           LogLevel sinkLevel)
+    {
+        bool binary = toFile && binaryFile;
+
+        // Build message once, unless only the binary file or record sinks want the record
+        std::string fullMessage;
+        if (toConsole || (toFile && !binary)) {
+            std::string timestamp = getTimestamp(now);
+            const char* levelStr = toString(currentLevel);
+
+            std::ostringstream oss;
+            oss << timestamp << levelStr << " | " << buffer;
+            if (truncated) {
+                oss << " [TRUNCATED]";
+            }
+            oss << "\n";
+
+            fullMessage = oss.str();
         }
-        oss << "\n";
-        
-        std::string fullMessage = oss.str();
 
         // Console output
-        if (currentLevel >= consoleThreshold) {
+        if (toConsole) {
             if (useColors) {
                 std::printf("%s%s\033[0m", getColor(currentLevel), fullMessage.c_str());
             } else {
@@ -384,97 +887,1699 @@ struct LogBuffer
         }
 
         // File output
-        if (fileLoggingEnabled && currentLevel >= fileThreshold && logFile.is_open()) {
-            logFile << fullMessage;
+        if (toFile) {
+            if (!ringFile && rotationInterval != RotationInterval::NONE && now >= nextRotationTime) {
+                rotateOnTimeUnsafe(now);
+            }
+            if (!ringFile && maxFileSize > 0) {
+                prepareRotationUnsafe(binary ? args.size + 3 * binlog::MAX_VARINT : fullMessage.size());
+            }
+            int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+            bool intervalDue = micros >= nextIndexMicros || (ringFile && fileBytes >= nextRingHeaderBytes);
+            if ((indexedFile || ringFile) && intervalDue) {
+                indexRecordUnsafe(micros);
+            }
+            if (binary) {
+                if (sharedFile) {
+                    // Records of other processes may come between any two of ours
+                    binaryHeaderPending = true;
+                }
+                encodeBinaryUnsafe(micros);
+                logFile->write(binaryRecord.data(), binaryRecord.size());
+                fileBytes += binaryRecord.size();
+                unflushedBytes += binaryRecord.size();
+                ++unflushedRecords;
+            } else {
+                logFile->write(fullMessage.data(), fullMessage.size());
+                fileBytes += fullMessage.size();
+                unflushedBytes += fullMessage.size();
+                ++unflushedRecords;
+            }
             if (shouldFlush()) {
-                logFile.flush();
+                logFile->flush();
+                unflushedBytes = 0;
+                unflushedRecords = 0;
             }
         }
 
-        reset();
+        if (sinks) {
+            consumeSinksUnsafe(now, sinkLevel);
+        }
     }
 
     /**
-     * @brief Prints the log message with improved performance.
+     * @brief Keeps the current, suppressed record in the backtrace, dropping the oldest if it is full.
      */
-    void print()
+    void keepBacktraceUnsafe(std::chrono::system_clock::time_point now)
     {
-        std::lock_guard<std::mutex> lock(logMutex);
-        printUnsafe();
+        size_t slot = (backtraceStart + backtraceCount) % backtraceLimit;
+        if (backtraceCount == backtraceLimit) {
+            backtraceStart = (backtraceStart + 1) % backtraceLimit;
+        } else {
+            ++backtraceCount;
+        }
+        BacktraceEntry& entry = backtrace[slot];
+        entry.level = currentLevel;
+        entry.sequence = sequence;
+        entry.time = now;
+        entry.truncated = args.overflow;
+        // assign() keeps the capacity of the string the slot held before
+        entry.args.assign(reinterpret_cast<const char*>(args.data), args.size);
     }
 
     /**
-     * @brief Manually flush the log file.
+     * @brief Writes the backtrace, oldest first and marked, wherever the current record goes.
+     *
+     * Backtrace records keep their own level, sequence number and time. The
+     * current record is set aside meanwhile and restored afterwards.
      */
-    void flush()
+    void replayBacktraceUnsafe(bool toConsole, bool toFile, bool sinks)
     {
-        std::lock_guard<std::mutex> lock(logMutex);
-        if (logFile.is_open()) {
-            logFile.flush();
+        LogLevel level = currentLevel;
+        uint64_t current = sequence;
+        bool wasTruncated = truncated;
+        std::string text(buffer, size);
+        auto saved = std::make_unique<binlog::ArgBuffer<BUFFER_SIZE>>(args);
+
+        std::string rendered;
+        for (size_t i = 0; i < backtraceCount; ++i) {
+            const BacktraceEntry& entry = backtrace[(backtraceStart + i) % backtraceLimit];
+            rendered.assign(BACKTRACE_MARK);
+            rendered += ' ';
+            binlog::renderArgs(reinterpret_cast<const uint8_t*>(entry.args.data()), entry.args.size(), rendered);
+            size = std::min(rendered.size(), BUFFER_SIZE - 1);
+            std::memcpy(buffer, rendered.data(), size);
+            buffer[size] = '\0';
+            truncated = entry.truncated || size < rendered.size();
+
+            args.clear();
+            args.putString(BACKTRACE_MARK, std::strlen(BACKTRACE_MARK));
+            if (args.reserve(entry.args.size())) {
+                std::memcpy(args.data + args.size, entry.args.data(), entry.args.size());
+                args.size += entry.args.size();
+            }
+            args.overflow = args.overflow || entry.truncated;
+
+            currentLevel = entry.level;
+            sequence = entry.sequence;
+            writeRecordUnsafe(entry.time, toConsole, toFile, sinks, level);
         }
-    }
+        backtraceStart = 0;
+        backtraceCount = 0;
 
-    /**
-     * @brief Sets the current log level.
-     */
-    void setLevel(LogLevel level)
-    {
         currentLevel = level;
+        sequence = current;
+        truncated = wasTruncated;
+        std::memcpy(buffer, text.data(), text.size());
+        size = text.size();
+        buffer[size] = '\0';
+        args = *saved;
     }
 
     /**
-     * @brief Sets the console log level threshold.
+     * @brief Stores the current record's typed arguments in the flight recorder.
      */
-    void setConsoleThreshold(LogLevel level)
+    void recordFlightUnsafe(std::chrono::system_clock::time_point now)
     {
-        consoleThreshold = level;
+        int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        uint8_t level = static_cast<uint8_t>(currentLevel);
+        if (args.overflow) {
+            level |= binlog::LEVEL_TRUNCATED;
+        }
+        flightRecorder.record(sequence, micros, level, args.data, args.size);
     }
 
     /**
-     * @brief Sets the file log level threshold.
+     * @brief Hands the current record to every record sink whose threshold it meets.
      */
-    void setFileThreshold(LogLevel level)
+    void consumeSinksUnsafe(std::chrono::system_clock::time_point now, LogLevel sinkLevel)
     {
-        fileThreshold = level;
+        // Every argument ends with a separator; sinks get the message without it
+        size_t length = size;
+        while (length > 0 && buffer[length - 1] == ' ') {
+            --length;
+        }
+        LogRecord record {currentLevel, sequence, now, std::string_view(buffer, length), truncated};
+        for (const SinkEntry& entry : recordSinks) {
+            if (sinkLevel >= entry.threshold) {
+                entry.sink->consume(record);
+            }
+        }
     }
 
     /**
-     * @brief Sets the flush policy for file logging.
+     * @brief Blocks until the record with @p ticket is on disk (call without logMutex).
+     *
+     * The first waiter becomes the leader: it lets the group commit window
+     * pass, then syncs everything written so far with one fdatasync. Waiters
+     * arriving meanwhile share that sync or the next one.
      */
-    void setFlushPolicy(FlushPolicy policy)
+    void waitDurable(uint64_t ticket)
     {
-        std::lock_guard<std::mutex> lock(logMutex);
-        flushPolicy = policy;
+        if (ticket == 0) return;
+        std::unique_lock<std::mutex> lock(commitMutex);
+        while (durableSynced < ticket) {
+            if (commitLeader) {
+                commitDone.wait(lock);
+                continue;
+            }
+            commitLeader = true;
+            lock.unlock();
+            uint64_t covered = commitDurable();
+            lock.lock();
+            durableSynced = std::max(durableSynced, covered);
+            commitLeader = false;
+            commitDone.notify_all();
+        }
     }
 
     /**
-     * @brief Enables file logging with optional custom filename.
+     * @brief Leader side of waitDurable(): syncs the current file, returning the last ticket covered.
      */
-    void enableFileLogging(const std::string& filename = "")
+    uint64_t commitDurable()
     {
-        std::lock_guard<std::mutex> lock(logMutex);
-        
+        std::chrono::microseconds window;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            window = groupCommitWindow;
+        }
+        if (window.count() > 0) {
+            std::this_thread::sleep_for(window);
+        }
+
+        uint64_t target;
+        int fd = -1;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            target = durableIssued;
+            durableCaptured = target;
+            if (logFile && logFile->isOpen()) {
+#ifndef _WIN32
+                int handle = logFile->syncHandle();
+                if (handle >= 0) {
+                    fd = ::dup(handle);
+                }
+#endif
+                if (fd < 0) {
+                    logFile->sync();
+                }
+            }
+        }
+
+#ifndef _WIN32
+        // The duplicate stays valid even if the sink is rotated away meanwhile
+        if (fd >= 0) {
+            ::fdatasync(fd);
+            ::close(fd);
+        }
+#endif
+        return target;
+    }
+
+    /**
+     * @brief Syncs a file leaving service if it holds durable records no sync has covered yet.
+     */
+    void syncRetiringUnsafe(FileSink& sink)
+    {
+        if (durableIssued > durableCaptured) {
+            sink.sync();
+        }
+    }
+
+    /**
+     * @brief Encodes the current record into binaryRecord, after a header if the segment is new.
+     */
+    void encodeBinaryUnsafe(int64_t micros)
+    {
+        binaryRecord.clear();
+        if (binaryHeaderPending) {
+            binlog::encodeHeader(binaryRecord, binaryState, includeDate, micros, sequence);
+            binaryHeaderPending = false;
+        }
+        uint8_t level = static_cast<uint8_t>(currentLevel);
+        if (args.overflow) {
+            level |= binlog::LEVEL_TRUNCATED;
+        }
+        binlog::encodeRecord(binaryRecord, binaryState, sequence, micros, level, args.data, args.size);
+    }
+
+    /**
+     * @brief Adds an index entry for the record about to be written at fileBytes.
+     *
+     * Ring files get no entries, only a binary header every second and every
+     * 1/64 of the ring, so decoding resumes soon after the overwritten records.
+     */
+    void indexRecordUnsafe(int64_t micros)
+    {
+        int64_t interval = indexedFile ? std::chrono::duration_cast<std::chrono::microseconds>(indexInterval).count()
+                                       : 1'000'000;
+        nextIndexMicros = (micros / interval + 1) * interval;
+        // A binary file restarts its delta encoding here, so decoding can begin at the entry
+        binaryHeaderPending = true;
+        nextRingHeaderBytes = fileBytes + ringHeaderSpacing;
+        if (!indexedFile) return;
+
+        std::string entry;
+        logindex::appendEntry(entry, {micros, sequence, fileBytes});
+        std::string path = logindex::indexPath(currentPath);
+        uint32_t seconds = static_cast<uint32_t>(indexInterval.count());
+        worker.post([path, seconds, entry] { logindex::appendEntries(path, seconds, entry); });
+    }
+
+    /**
+     * @brief Prints the log message with improved performance.
+     */
+    void print()
+    {
+        PrintTicket ticket;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            ticket = printUnsafe();
+        }
+        completePrint(ticket);
+    }
+
+    /**
+     * @brief Finishes a record on the logging thread, without logMutex: writes its FATAL dump and waits for the disk.
+     *
+     * The dump is written before the caller goes on, so it survives an
+     * abort() or _exit() that follows the FATAL record.
+     */
+    void completePrint(PrintTicket& ticket)
+    {
+        if (ticket.flightDump) {
+            writeFlightDump(*ticket.flightDump);
+        }
+        waitDurable(ticket.durable);
+    }
+
+    /**
+     * @brief Logs a record produced elsewhere (e.g. by another process), keeping its level and timestamp.
+     */
+    void printRecord(LogLevel level, std::chrono::system_clock::time_point time, std::string_view message,
+                     bool wasTruncated = false)
+    {
+        PrintTicket ticket;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            setLevel(level);
+            append(message);
+            truncated = truncated || wasTruncated;
+            ticket = printUnsafe(time);
+        }
+        completePrint(ticket);
+    }
+
+    /**
+     * @brief Manually flush the log file.
+     */
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+#ifndef _WIN32
+        drainSignalLogUnsafe();
+#endif
+        if (logFile && logFile->isOpen()) {
+            logFile->flush();
+        }
+        unflushedBytes = 0;
+        unflushedRecords = 0;
+        for (const SinkEntry& entry : recordSinks) {
+            entry.sink->flush();
+        }
+    }
+
+    /**
+     * @brief Sends records at or above @p threshold to @p sink as well.
+     */
+    void addSink(std::shared_ptr<RecordSink> sink, LogLevel threshold = LOG_VERBOSE)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        recordSinks.push_back({std::move(sink), threshold});
+        updateSinkThresholdUnsafe();
+    }
+
+    /**
+     * @brief Stops sending records to @p sink.
+     */
+    void removeSink(const std::shared_ptr<RecordSink>& sink)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::erase_if(recordSinks, [&sink](const SinkEntry& entry) { return entry.sink == sink; });
+        updateSinkThresholdUnsafe();
+    }
+
+    /**
+     * @brief Recomputes the lowest sink threshold after the sink list changed.
+     */
+    void updateSinkThresholdUnsafe()
+    {
+        sinkThreshold = LOG_FIXED;
+        for (const SinkEntry& entry : recordSinks) {
+            sinkThreshold = std::min(sinkThreshold, entry.threshold);
+        }
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Sets the current log level.
+     */
+    void setLevel(LogLevel level)
+    {
+        currentLevel = level;
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Sets the console log level threshold.
+     */
+    void setConsoleThreshold(LogLevel level)
+    {
+        consoleThreshold = level;
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Sets the file log level threshold.
+     */
+    void setFileThreshold(LogLevel level)
+    {
+        fileThreshold = level;
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Sets the flush policy for file logging.
+     */
+    void setFlushPolicy(FlushPolicy policy)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        flushPolicy = policy;
+        if (hasRule(policy, FlushPolicy::INTERVAL) && !flushTimerArmed) {
+            scheduleFlushTimerUnsafe();
+        }
+    }
+
+    /**
+     * @brief Sets the longest time data may stay buffered under FlushPolicy::INTERVAL.
+     */
+    void setFlushInterval(std::chrono::milliseconds interval)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        flushInterval = interval;
+    }
+
+    /**
+     * @brief Sets the pending byte count that triggers a flush under FlushPolicy::BYTES.
+     */
+    void setFlushBytes(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        flushBytes = bytes;
+    }
+
+    /**
+     * @brief Flushes pending data from the worker every flushInterval while INTERVAL is set.
+     *
+     * The timer does the flush, so a quiet logger still gets its data out.
+     */
+    void scheduleFlushTimerUnsafe()
+    {
+        flushTimerArmed = true;
+        worker.postAt(std::chrono::steady_clock::now() + flushInterval, [this] {
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!hasRule(flushPolicy, FlushPolicy::INTERVAL)) {
+                flushTimerArmed = false;
+                return;
+            }
+            if (unflushedBytes > 0 && logFile && logFile->isOpen()) {
+                logFile->flush();
+                unflushedBytes = 0;
+                unflushedRecords = 0;
+            }
+            scheduleFlushTimerUnsafe();
+        });
+    }
+
+    /**
+     * @brief Makes records covered by @p policy return only once they are on disk.
+     *
+     * Records arriving while a sync runs share the next one; a @p window
+     * delays each sync so that more records can join it.
+     */
+    void setDurabilityPolicy(DurabilityPolicy policy,
+                             std::chrono::microseconds window = std::chrono::microseconds(0))
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        durabilityPolicy = policy;
+        groupCommitWindow = window;
+    }
+
+    /**
+     * @brief Returns the position of the extension dot in @p path, or npos.
+     */
+    static size_t extensionPos(const std::string& path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return std::string::npos;
+        }
+        return dot;
+    }
+
+    /**
+     * @brief Builds the path of rotation segment @p index: log.txt, log.1.txt, log.2.txt ...
+     */
+    static std::string segmentPath(const std::string& base, size_t index)
+    {
+        if (index == 0) {
+            return base;
+        }
+        size_t dot = extensionPos(base);
+        if (dot == std::string::npos) {
+            return base + "." + std::to_string(index);
+        }
+        return base.substr(0, dot) + "." + std::to_string(index) + base.substr(dot);
+    }
+
+    /**
+     * @brief Builds a time-stamped file name: log_YYYYMMDD_HHMMSS.txt (with
+     * @p extension), or name_YYYYMMDD_HHMMSS.ext for a custom @p name.
+     */
+    static std::string timedPath(const std::string& name, std::time_t t, const char* extension = ".txt")
+    {
+        std::tm tm;
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        std::ostringstream oss;
+        if (name.empty()) {
+            oss << "log_" << std::put_time(&tm, "%Y%m%d_%H%M%S") << extension;
+            return oss.str();
+        }
+
+        size_t dot = extensionPos(name);
+        oss << name.substr(0, dot) << "_" << std::put_time(&tm, "%Y%m%d_%H%M%S");
+        if (dot != std::string::npos) {
+            oss << name.substr(dot);
+        }
+        return oss.str();
+    }
+
+    /**
+     * @brief Returns the start of the rotation period containing @p now, moved by @p step periods.
+     */
+    static std::chrono::system_clock::time_point rotationBoundary(std::chrono::system_clock::time_point now,
+                                                                  RotationInterval interval, int step)
+    {
+        std::time_t t = std::chrono::system_clock::to_time_t(now);
+        std::tm tm;
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        tm.tm_sec = 0;
+        tm.tm_min = 0;
+        if (interval == RotationInterval::DAILY) {
+            tm.tm_hour = 0;
+            tm.tm_mday += step;
+        } else {
+            tm.tm_hour += step;
+        }
+        tm.tm_isdst = -1;
+        return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    }
+
+    /**
+     * @brief Deletes @p path if it exists and is empty (an unused pre-opened segment).
+     */
+    static void removeIfEmpty(const std::string& path)
+    {
+        std::error_code ec;
+        if (std::filesystem::file_size(path, ec) == 0 && !ec) {
+            std::filesystem::remove(path, ec);
+        }
+    }
+
+    /**
+     * @brief Has the worker open @p path at @p when and park it as the next size (or timed) segment.
+     */
+    void preopenUnsafe(const std::string& path, bool timed, std::chrono::steady_clock::time_point when)
+    {
+        FileSinkOptions options = fileOptions;
+        uint64_t generation = fileGeneration;
+
+        worker.postAt(when, [this, path, timed, options, generation] {
+            {
+                std::lock_guard<std::mutex> lock(logMutex);
+                if (generation != fileGeneration) return;
+            }
+
+            std::unique_ptr<FileSink> sink = makeFileSink(path, options);
+            {
+                std::lock_guard<std::mutex> lock(logMutex);
+                // Stale if logging was restarted, the period changed or the segment was opened inline
+                std::string wanted = timed ? nextTimedPath : segmentPath(filePath, segmentIndex + 1);
+                if (generation == fileGeneration && path == wanted && sink->isOpen()) {
+                    (timed ? nextTimedFile : nextFile) = std::move(sink);
+                    return;
+                }
+                if (path == currentPath) return;
+            }
+            sink.reset();
+            removeIfEmpty(path);
+        });
+    }
+
+    /**
+     * @brief Closes a pre-opened segment that will not be used, on the worker.
+     */
+    void discardUnsafe(std::unique_ptr<FileSink> sink, const std::string& path)
+    {
+        std::shared_ptr<FileSink> unused(std::move(sink));
+        worker.post([unused, path] {
+            unused->close();
+            removeIfEmpty(path);
+        });
+    }
+
+    /**
+     * @brief Makes @p next the current file; the old one is closed and old segments pruned on the worker.
+     */
+    void switchFileUnsafe(std::unique_ptr<FileSink> next, const std::string& path)
+    {
+        std::shared_ptr<FileSink> previous(std::move(logFile));
+        if (previous) {
+            syncRetiringUnsafe(*previous);
+        }
+        // Block-compressed files are already compressed
+        retireSegmentUnsafe(previous, currentPath, fileBytes,
+                            fileOptions.blockCompression ? CompressionCodec::NONE : segmentCompression);
+        logFile = std::move(next);
+        currentPath = path;
+        fileBytes = 0;
+        beginFileUnsafe();
+    }
+
+    /**
+     * @brief Fixes the format and index settings of a file that just became current.
+     */
+    void beginFileUnsafe()
+    {
+        binaryFile = fileFormat == LogFileFormat::BINARY;
+        binaryHeaderPending = true;
+        unflushedBytes = 0;
+        unflushedRecords = 0;
+        ringFile = fileOptions.ringSize > 0;
+        sharedFile = !ringFile && fileOptions.ioMode == FileIoMode::SHARED;
+        ringHeaderSpacing = fileOptions.ringSize / 64;
+        nextRingHeaderBytes = 0;
+        // Offsets into a compressed stream, a ring or a file other processes extend mean nothing to a reader
+        indexedFile = indexInterval.count() > 0 && !fileOptions.blockCompression && !ringFile && !sharedFile;
+        nextIndexMicros = 0;
+    }
+
+    /**
+     * @brief Closes a finished segment on the worker and hands it to the retention policy.
+     *
+     * With a codec set, the closed segment is then queued for compression.
+     */
+    void retireSegmentUnsafe(std::shared_ptr<FileSink> sink, const std::string& path, uint64_t bytes,
+                             CompressionCodec codec = CompressionCodec::NONE)
+    {
+        worker.post([this, sink, path, bytes, codec] {
+            if (sink) {
+                sink->close();
+            }
+            retainedSegments.push_back({path, logindex::indexPath(path), bytes, std::chrono::system_clock::now()});
+            enforceRetention();
+
+            if (codec != CompressionCodec::NONE) {
+                compressor.post([this, path, codec] {
+                    std::string packed = compressSegment(path, codec);
+                    if (!packed.empty()) {
+                        worker.post([this, path, packed] { adoptCompressedSegment(path, packed); });
+                    }
+                });
+            }
+        });
+    }
+
+    /**
+     * @brief Replaces a retained segment by its compressed copy (worker thread).
+     */
+    void adoptCompressedSegment(const std::string& path, const std::string& packed)
+    {
+        std::error_code ec;
+        for (auto& segment : retainedSegments) {
+            if (segment.path == path) {
+                std::filesystem::remove(path, ec);
+                auto size = std::filesystem::file_size(packed, ec);
+                segment.path = packed;
+                segment.bytes = ec ? 0 : static_cast<uint64_t>(size);
+                return;
+            }
+        }
+        // Retention dropped the segment while it was being compressed
+        std::filesystem::remove(packed, ec);
+    }
+
+    /**
+     * @brief Compresses each segment closed by rotation; the live segment stays plain text.
+     */
+    void setSegmentCompression(CompressionCodec codec)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        segmentCompression = codec;
+    }
+
+    /**
+     * @brief Deletes the oldest closed segments until the retention policy holds (worker thread).
+     *
+     * Only segments this logger produced are considered, so no directory scan is needed.
+     */
+    void enforceRetention()
+    {
+        RetentionPolicy policy;
+        uint64_t total = 0;
+        size_t count = retainedSegments.size();
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            policy = retention;
+            if (fileLoggingEnabled) {
+                total = fileBytes;
+                ++count;
+            }
+        }
+        for (const auto& segment : retainedSegments) {
+            total += segment.bytes;
+        }
+
+        auto now = std::chrono::system_clock::now();
+        while (!retainedSegments.empty()) {
+            const LogSegment& oldest = retainedSegments.front();
+            bool overCount = policy.maxFiles > 0 && count > policy.maxFiles;
+            bool overBytes = policy.maxTotalBytes > 0 && total > policy.maxTotalBytes;
+            bool tooOld = policy.maxAge.count() > 0 && now - oldest.closedAt > policy.maxAge;
+            if (!overCount && !overBytes && !tooOld) {
+                break;
+            }
+
+            std::error_code ec;
+            std::filesystem::remove(oldest.path, ec);
+            std::filesystem::remove(oldest.index, ec);
+            total -= oldest.bytes;
+            --count;
+            retainedSegments.pop_front();
+        }
+    }
+
+    /**
+     * @brief Re-checks segment ages periodically while maxAge is set.
+     */
+    void scheduleRetentionCheckUnsafe()
+    {
+        retentionTimerArmed = true;
+        worker.postAt(std::chrono::steady_clock::now() + RETENTION_CHECK_INTERVAL, [this] {
+            enforceRetention();
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (retention.maxAge.count() > 0) {
+                scheduleRetentionCheckUnsafe();
+            } else {
+                retentionTimerArmed = false;
+            }
+        });
+    }
+
+    /**
+     * @brief Sets the retention budget for the segments this logger writes.
+     */
+    void setRetentionPolicy(const RetentionPolicy& policy)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        retention = policy;
+        if (retention.maxAge.count() > 0 && !retentionTimerArmed) {
+            scheduleRetentionCheckUnsafe();
+        }
+        worker.post([this] { enforceRetention(); });
+    }
+
+    /**
+     * @brief Switches segments before a record that would cross maxFileSize.
+     *
+     * The next segment is opened by the worker once the current one is three
+     * quarters full, so the switch is normally a pointer swap.
+     */
+    void prepareRotationUnsafe(size_t recordSize)
+    {
+        if (!nextFileRequested && fileBytes + recordSize > maxFileSize - maxFileSize / 4) {
+            nextFileRequested = true;
+            preopenUnsafe(segmentPath(filePath, segmentIndex + 1), false, std::chrono::steady_clock::now());
+        }
+        if (fileBytes == 0 || fileBytes + recordSize <= maxFileSize) {
+            return;
+        }
+
+        std::string path = segmentPath(filePath, segmentIndex + 1);
+        std::unique_ptr<FileSink> next = std::move(nextFile);
+        if (!next) {
+            // The worker has not caught up yet; open inline rather than overrun the limit
+            next = makeFileSink(path, fileOptions);
+            if (!next->isOpen()) {
+                return;
+            }
+        }
+
+        ++segmentIndex;
+        nextFileRequested = false;
+        switchFileUnsafe(std::move(next), path);
+    }
+
+    /**
+     * @brief Computes the next period boundary and schedules its segment to be opened just before it.
+     */
+    void scheduleTimedRotationUnsafe(std::chrono::system_clock::time_point now)
+    {
+        using namespace std::chrono;
+        nextRotationTime = rotationBoundary(now, rotationInterval, 1);
+        nextTimedPath = timedPath(fileName, system_clock::to_time_t(nextRotationTime), defaultExtension());
+
+        auto lead = nextRotationTime - ROTATION_PREOPEN_LEAD - system_clock::now();
+        preopenUnsafe(nextTimedPath, true, steady_clock::now() + duration_cast<steady_clock::duration>(lead));
+    }
+
+    /**
+     * @brief Starts the segment of the period containing @p now.
+     */
+    void rotateOnTimeUnsafe(std::chrono::system_clock::time_point now)
+    {
+        auto boundary = rotationBoundary(now, rotationInterval, 0);
+        std::string path = timedPath(fileName, std::chrono::system_clock::to_time_t(boundary), defaultExtension());
+
+        std::unique_ptr<FileSink> next;
+        if (nextTimedFile && nextTimedPath == path) {
+            next = std::move(nextTimedFile);
+        } else {
+            // Pre-open missed (no record near the boundary and a slow worker, or a clock jump)
+            if (nextTimedFile) {
+                discardUnsafe(std::move(nextTimedFile), nextTimedPath);
+            }
+            next = makeFileSink(path, fileOptions);
+        }
+
+        if (next->isOpen()) {
+            if (nextFile) {
+                discardUnsafe(std::move(nextFile), segmentPath(filePath, segmentIndex + 1));
+            }
+            ++fileGeneration;
+            filePath = path;
+            segmentIndex = 0;
+            nextFileRequested = false;
+            switchFileUnsafe(std::move(next), path);
+        }
+        scheduleTimedRotationUnsafe(now);
+    }
+
+    /**
+     * @brief Enables size-based rotation; the retention policy is left as it is.
+     */
+    void setFileRotation(size_t maxBytes)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        maxFileSize = maxBytes;
+    }
+
+    /**
+     * @brief Enables size-based rotation; @p maxFileCount sets RetentionPolicy::maxFiles (0 keeps every segment).
+     */
+    void setFileRotation(size_t maxBytes, size_t maxFileCount)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        maxFileSize = maxBytes;
+        retention.maxFiles = maxFileCount;
+    }
+
+    /**
+     * @brief Enables hourly or daily rotation on local-time period boundaries.
+     */
+    void setTimeRotation(RotationInterval interval)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        rotationInterval = interval;
+        if (nextTimedFile) {
+            discardUnsafe(std::move(nextTimedFile), nextTimedPath);
+        }
+        nextTimedPath.clear();
+        if (fileLoggingEnabled && !ringFile && interval != RotationInterval::NONE) {
+            scheduleTimedRotationUnsafe(std::chrono::system_clock::now());
+        }
+    }
+
+    /**
+     * @brief Selects the file backend; takes effect the next time a file is opened.
+     */
+    void setFileIoMode(FileIoMode mode)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        fileOptions.ioMode = mode;
+    }
+
+    /**
+     * @brief Writes the file as independent LZ4 frames compressed on a background thread.
+     *
+     * Takes effect the next time a file is opened; default names end in .txt.lz4.
+     */
+    void setFileBlockCompression(bool enable)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        fileOptions.blockCompression = enable;
+    }
+
+    /**
+     * @brief Writes the file as text lines or as binary records for ulog-decode.
+     *
+     * Takes effect the next time a file is opened; default binary names end in .ulog.
+     */
+    void setFileFormat(LogFileFormat format)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        fileFormat = format;
+        fileOptions.binaryRecords = format == LogFileFormat::BINARY;
+    }
+
+    /**
+     * @brief Writes a sidecar index (file path + ".idx") with an entry every @p interval; 0 disables it.
+     *
+     * Takes effect the next time a file is opened. Block-compressed files are not indexed.
+     */
+    void setFileIndex(std::chrono::seconds interval)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        indexInterval = interval;
+    }
+
+    /**
+     * @brief Reserves disk space @p bytes at a time ahead of the writes (FD and io_uring backends); 0 disables.
+     */
+    void setFilePreallocation(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        fileOptions.preallocateSize = bytes;
+    }
+
+    /**
+     * @brief Evicts log pages from the page cache once they are on disk (FD and io_uring backends).
+     */
+    void setFileCacheDrop(bool enable)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        fileOptions.dropCache = enable;
+    }
+
+    /**
+     * @brief Writes a preallocated ring of @p bytes that wraps instead of growing; 0 writes a normal file.
+     *
+     * Takes effect the next time a file is opened. Rotation, block compression
+     * and the time index do not apply to a ring. Not available on Windows.
+     */
+    void setFileRing(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        fileOptions.ringSize = bytes;
+    }
+
+    /**
+     * @brief Extension of generated file names for the current file options.
+     */
+    const char* defaultExtension() const
+    {
+        if (fileOptions.ringSize > 0) {
+            return fileFormat == LogFileFormat::BINARY ? ".ulog.ring" : ".txt.ring";
+        }
+        if (fileFormat == LogFileFormat::BINARY) {
+            return fileOptions.blockCompression ? ".ulog.lz4" : ".ulog";
+        }
+        return fileOptions.blockCompression ? ".txt.lz4" : ".txt";
+    }
+
+    /**
+     * @brief Reopens the current file path, e.g. after logrotate renamed the file.
+     *
+     * The new file is opened on the worker and swapped in under the lock;
+     * records written before the swap are flushed to the old file as it is
+     * closed, so nothing is lost or written twice. Returns once done.
+     */
+    void reopenFile()
+    {
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!fileLoggingEnabled) return;
+            worker.post([this, path = currentPath, generation = fileGeneration] { reopenOnWorker(path, generation); });
+        }
+        worker.waitIdle();
+    }
+
+    /**
+     * @brief Worker side of reopenFile(); skipped if the file changed meanwhile.
+     */
+    void reopenOnWorker(const std::string& path, uint64_t generation)
+    {
+        FileSinkOptions options;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            options = fileOptions;
+        }
+        std::unique_ptr<FileSink> sink = makeFileSink(path, options);
+        if (!sink->isOpen()) return;
+
+        std::unique_ptr<FileSink> previous;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!fileLoggingEnabled || generation != fileGeneration || path != currentPath) {
+                return;
+            }
+            previous = std::move(logFile);
+            if (previous) {
+                syncRetiringUnsafe(*previous);
+            }
+            logFile = std::move(sink);
+
+            std::error_code ec;
+            auto existing = std::filesystem::file_size(path, ec);
+            fileBytes = ec ? 0 : static_cast<size_t>(existing);
+            beginFileUnsafe();
+            updateCaptureFlags();
+        }
+        // The old file now belongs to whoever renamed it; it is not tracked for retention
+        if (previous) {
+            previous->close();
+        }
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief Reopens the file whenever @p signal arrives (SIGHUP by default, as logrotate sends).
+     *
+     * The handler only counts signals; the worker notices within
+     * REOPEN_POLL_INTERVAL and reopens there. The poll only runs while file
+     * logging is enabled.
+     */
+    void enableReopenOnSignal(int signal = SIGHUP)
+    {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = reopenSignalHandler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        ::sigaction(signal, &action, nullptr);
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        reopenOnSignal = true;
+        armReopenPollUnsafe();
+    }
+
+    /**
+     * @brief Starts the reopen poll if it is wanted and file logging is on.
+     */
+    void armReopenPollUnsafe()
+    {
+        if (reopenOnSignal && fileLoggingEnabled && !reopenPollArmed) {
+            // Signals received while no file was open asked for nothing
+            reopenSignalsSeen = reopenSignals.load(std::memory_order_relaxed);
+            scheduleReopenPollUnsafe();
+        }
+    }
+
+    void scheduleReopenPollUnsafe()
+    {
+        reopenPollArmed = true;
+        worker.postAt(std::chrono::steady_clock::now() + REOPEN_POLL_INTERVAL, [this] {
+            unsigned received = reopenSignals.load(std::memory_order_relaxed);
+            std::string path;
+            uint64_t generation;
+            bool due;
+            {
+                std::lock_guard<std::mutex> lock(logMutex);
+                if (!fileLoggingEnabled) {
+                    // Re-armed by enableFileLogging()
+                    reopenPollArmed = false;
+                    return;
+                }
+                due = received != reopenSignalsSeen;
+                reopenSignalsSeen = received;
+                path = currentPath;
+                generation = fileGeneration;
+                scheduleReopenPollUnsafe();
+            }
+            if (due) {
+                reopenOnWorker(path, generation);
+            }
+        });
+    }
+#endif
+
+    /**
+     * @brief Keeps the last @p bytes of records, at every level, in an in-memory flight recorder.
+     *
+     * Records are kept in binary form, without text formatting, whatever
+     * the thresholds. The recorder is written out as text on FATAL and by
+     * dumpFlightRecorder(); with @p dumpOnCrash a crash signal writes it as
+     * a binary log, <prefix>_<pid>.ulog. 0 bytes turns the recorder off.
+     */
+    void setFlightRecorder(size_t bytes, bool dumpOnCrash = true, const std::string& dumpPrefix = "flight")
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+#ifndef _WIN32
+        // The crash handler must not read the recorder while it is reallocated
+        LogBuffer* self = this;
+        crashLogger.compare_exchange_strong(self, nullptr);
+#endif
+        flightRecorder.resize(bytes, BUFFER_SIZE);
+        flightDumpPrefix = dumpPrefix;
+        std::snprintf(crashDumpPrefix, sizeof(crashDumpPrefix), "%s", dumpPrefix.c_str());
+        crashFlightDump = dumpOnCrash;
+        updateCaptureFlags();
+#ifndef _WIN32
+        armCrashHandlerUnsafe();
+#endif
+    }
+
+    /**
+     * @brief Keeps the last @p records suppressed DEBUG and VERBOSE records, to be written before the next ERROR or FATAL.
+     *
+     * The records cost no text formatting unless they are written. They go
+     * wherever the ERROR or FATAL goes, oldest first, prefixed with
+     * "[backtrace]". 0 turns the backtrace off and drops what it holds.
+     */
+    void setBacktrace(size_t records)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        backtrace.clear();
+        backtrace.resize(records);
+        backtraceLimit = records;
+        backtraceStart = 0;
+        backtraceCount = 0;
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Writes the flight recorder as text to @p path (default <prefix>_<time>_<pid>_<sequence>.txt).
+     * @return The path written, or an empty string.
+     */
+    std::string dumpFlightRecorder(const std::string& path = "")
+    {
+        std::unique_ptr<FlightDump> dump;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!flightRecorder.isEnabled()) return "";
+            dump = captureFlightDumpUnsafe(path);
+        }
+        return writeFlightDump(*dump) ? dump->path : "";
+    }
+
+    /**
+     * @brief Copies the flight recorder out for a dump to @p path (empty for a generated name).
+     */
+    std::unique_ptr<FlightDump> captureFlightDumpUnsafe(const std::string& path) const
+    {
+        auto dump = std::make_unique<FlightDump>();
+        dump->path = path.empty() ? flightDumpPathUnsafe() : path;
+        dump->includeDate = includeDate;
+        dump->entries = flightRecorder.snapshot();
+        return dump;
+    }
+
+    /**
+     * @brief Names a dump after the time, the process and the last record, so no two dumps collide.
+     */
+    std::string flightDumpPathUnsafe() const
+    {
+        std::string path = timedPath(flightDumpPrefix, std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()), "");
+        return path + "_" + std::to_string(processId()) + "_" + std::to_string(sequence) + ".txt";
+    }
+
+    /**
+     * @brief Renders captured flight recorder entries as text lines, oldest first.
+     */
+    static std::string renderFlightDump(FlightDump& dump)
+    {
+        std::string text;
+        dump.entries->forEach([&](const FlightRecorder::Entry& entry) {
+            auto micros = std::chrono::microseconds(entry.micros);
+            text += formatTimestamp(std::chrono::system_clock::time_point(micros), dump.includeDate);
+            text += toString(static_cast<LogLevel>(entry.level & ~binlog::LEVEL_TRUNCATED));
+            text += " | ";
+            binlog::renderArgs(entry.args, entry.argsSize, text);
+            if (entry.level & binlog::LEVEL_TRUNCATED) {
+                text += " [TRUNCATED]";
+            }
+            text += "\n";
+        });
+        return text;
+    }
+
+    static bool writeFlightDump(FlightDump& dump)
+    {
+        std::string text = renderFlightDump(dump);
+        std::FILE* out = std::fopen(dump.path.c_str(), "w");
+        if (!out) return false;
+        bool written = std::fwrite(text.data(), 1, text.size(), out) == text.size();
+        return (std::fclose(out) == 0) && written;
+    }
+
+    static long processId()
+    {
+#ifdef _WIN32
+        return _getpid();
+#else
+        return static_cast<long>(::getpid());
+#endif
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief Returns the local offset from UTC in seconds; signal handlers cannot call localtime_r().
+     */
+    static long currentUtcOffset()
+    {
+        std::time_t t = std::time(nullptr);
+        std::tm tm;
+        localtime_r(&t, &tm);
+        return tm.tm_gmtoff;
+    }
+
+    /**
+     * @brief Sets up @p slots preallocated slots for LOG_SIGNAL records (0 turns it off).
+     *
+     * Call it before any handler may log. Records are drained into the
+     * regular outputs after the next LOG_PRINT, on flush() and every
+     * SIGNAL_LOG_POLL_INTERVAL. With @p echoFd (e.g. STDERR_FILENO) each
+     * record is also written there at once, for handlers that end the
+     * process before a drain.
+     */
+    void enableSignalLog(size_t slots = 256, int echoFd = -1)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        drainSignalLogUnsafe();
+        signalLog.resize(slots);
+        signalEchoFd = echoFd;
+        signalUtcOffset = currentUtcOffset();
+        if (slots > 0 && !signalPollArmed) {
+            scheduleSignalPollUnsafe();
+        }
+    }
+
+    /**
+     * @brief Logs a record from a signal handler or wherever locks and allocation are off limits.
+     *
+     * Takes string literals, integers, bools, chars and signalHex() values,
+     * formatted like LOG_STRING, LOG_INT and LOG_HEX*. Needs no lock and
+     * never waits: the record goes into a free slot, or is dropped and
+     * counted if every slot is taken. Text beyond SignalLog::TEXT_SIZE is
+     * cut and marked truncated.
+     * @return False if the record was dropped.
+     */
+    template<typename... Args>
+    bool logSignalSafe(LogLevel level, const Args&... arguments)
+    {
+        char text[SignalLog::TEXT_SIZE];
+        SignalLog::Formatter formatter {text, sizeof(text)};
+        (formatter.add(arguments), ...);
+        int64_t micros = sigsafe::nowMicros();
+
+        if (signalEchoFd >= 0) {
+            char line[48 + SignalLog::TEXT_SIZE];
+            size_t length = sigsafe::putTimestamp(line, micros, signalUtcOffset, includeDate);
+            std::memcpy(line + length, toString(level), 7);
+            length += 7;
+            std::memcpy(line + length, " | ", 3);
+            length += 3;
+            std::memcpy(line + length, text, formatter.size);
+            length += formatter.size;
+            line[length++] = '\n';
+            sigsafe::writeAll(signalEchoFd, line, length);
+        }
+
+        uint64_t position;
+        SignalLog::Slot* slot = signalLog.claim(position);
+        if (!slot) return false;
+        slot->micros = micros;
+        slot->level = static_cast<uint8_t>(level);
+        slot->truncated = formatter.truncated;
+        slot->size = static_cast<uint16_t>(formatter.size);
+        std::memcpy(slot->text, text, formatter.size);
+        SignalLog::publish(*slot, position);
+        return true;
+    }
+
+    /**
+     * @brief Logs the records LOG_SIGNAL has published since the last drain.
+     */
+    void drainSignalLog()
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        drainSignalLogUnsafe();
+    }
+
+    void drainSignalLogUnsafe()
+    {
+        if (drainingSignalLog || !signalLog.isEnabled()) return;
+        // Each drained record goes through printUnsafe(), which would drain again
+        drainingSignalLog = true;
+        signalLog.drain([this](const SignalLog::Slot& slot) {
+            size_t length = slot.size;
+            while (length > 0 && slot.text[length - 1] == ' ') {
+                --length;
+            }
+            setLevel(static_cast<LogLevel>(slot.level));
+            append(std::string_view(slot.text, length));
+            truncated = truncated || slot.truncated;
+            PrintTicket ticket = printUnsafe(std::chrono::system_clock::time_point(std::chrono::microseconds(slot.micros)));
+            if (ticket.flightDump) {
+                // No logging thread waits for this record; the worker writes its dump
+                std::shared_ptr<FlightDump> dump(std::move(ticket.flightDump));
+                worker.post([dump] { writeFlightDump(*dump); });
+            }
+        });
+        uint64_t dropped = signalLog.dropped.load(std::memory_order_relaxed);
+        if (dropped > signalDropsReported) {
+            setLevel(LOG_WARNING);
+            append("signal log full, records dropped:");
+            append(dropped - signalDropsReported);
+            printUnsafe();
+            signalDropsReported = dropped;
+        }
+        drainingSignalLog = false;
+    }
+
+    void scheduleSignalPollUnsafe()
+    {
+        signalPollArmed = true;
+        worker.postAt(std::chrono::steady_clock::now() + SIGNAL_LOG_POLL_INTERVAL, [this] {
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!signalLog.isEnabled()) {
+                signalPollArmed = false;
+                return;
+            }
+            drainSignalLogUnsafe();
+            scheduleSignalPollUnsafe();
+        });
+    }
+
+    /**
+     * @brief Writes what the file backend still buffers, then a FATAL crash record, when the process crashes.
+     *
+     * On SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT the handler drains the
+     * file using only async-signal-safe calls, adds a "crash: SIGSEGV
+     * (signal 11)" record to the file and the console, and lets the signal
+     * take its previous course. This makes buffered flush policies safe to
+     * use: only records still queued in record sinks are lost.
+     */
+    void setCrashHandler(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        crashDrain = enabled;
+        armCrashHandlerUnsafe();
+    }
+
+    /**
+     * @brief Makes this logger the crash logger if it wants crash signals, or stops being it.
+     */
+    void armCrashHandlerUnsafe()
+    {
+        LogBuffer* self = this;
+        if (!crashDrain && !(crashFlightDump && flightRecorder.isEnabled())) {
+            crashLogger.compare_exchange_strong(self, nullptr);
+            return;
+        }
+        signalUtcOffset = currentUtcOffset();
+        installCrashSignalStack();
+        installCrashHandlers();
+        crashLogger.store(this);
+    }
+
+    /**
+     * @brief Gives the calling thread an alternate signal stack for the crash handler.
+     *
+     * A stack overflow leaves no room to run the handler on the thread's own
+     * stack. The thread that enables the crash handler or flight recorder
+     * dump gets one; call this from every other thread that may overflow.
+     * @return True if the thread has an alternate signal stack.
+     */
+    static bool installCrashSignalStack()
+    {
+        thread_local CrashSignalStack stack;
+        stack_t current;
+        return ::sigaltstack(nullptr, &current) == 0 && !(current.ss_flags & SS_DISABLE);
+    }
+
+    /**
+     * @brief Installs crashSignalHandler for the crash signals, once per process.
+     */
+    static void installCrashHandlers()
+    {
+        static std::once_flag installed;
+        std::call_once(installed, [] {
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_sigaction = crashSignalHandler;
+            action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+            sigemptyset(&action.sa_mask);
+            for (size_t i = 0; i < std::size(CRASH_SIGNALS); ++i) {
+                ::sigaction(CRASH_SIGNALS[i], &action, &crashPreviousActions[i]);
+            }
+        });
+    }
+
+    /**
+     * @brief Runs the crash work this logger was armed for; async-signal-safe.
+     */
+    void handleCrashSignal(int signal)
+    {
+        if (crashDrain) {
+            drainOnCrash(signal);
+        }
+        if (crashFlightDump) {
+            dumpFlightRecorderOnCrash();
+        }
+    }
+
+    static const char* signalName(int signal)
+    {
+        switch (signal) {
+            case SIGSEGV: return "SIGSEGV";
+            case SIGBUS:  return "SIGBUS";
+            case SIGILL:  return "SIGILL";
+            case SIGFPE:  return "SIGFPE";
+            case SIGABRT: return "SIGABRT";
+            default:      return "signal";
+        }
+    }
+
+    /**
+     * @brief Drains the file backend and writes the crash record; async-signal-safe.
+     */
+    void drainOnCrash(int signal)
+    {
+        int64_t micros = sigsafe::nowMicros();
+
+        char message[64];
+        size_t messageSize = 0;
+        const char* name = signalName(signal);
+        std::memcpy(message, "crash: ", 7);
+        messageSize = 7;
+        std::memcpy(message + messageSize, name, std::strlen(name));
+        messageSize += std::strlen(name);
+        std::memcpy(message + messageSize, " (signal ", 9);
+        messageSize += 9;
+        messageSize += sigsafe::putDecimal(message + messageSize, static_cast<uint64_t>(signal));
+        message[messageSize++] = ')';
+
+        char line[160];
+        size_t lineSize = sigsafe::putTimestamp(line, micros, signalUtcOffset, includeDate);
+        std::memcpy(line + lineSize, toString(LOG_FATAL), 7);
+        lineSize += 7;
+        std::memcpy(line + lineSize, " | ", 3);
+        lineSize += 3;
+        std::memcpy(line + lineSize, message, messageSize);
+        lineSize += messageSize;
+        line[lineSize++] = '\n';
+
+        FileSink* sink = fileLoggingEnabled ? logFile.get() : nullptr;
+        if (sink && binaryFile) {
+            // A header of its own makes the record independent of the delta state mid-update
+            uint8_t record[binlog::HEADER_SIZE + binlog::MAX_RECORD_HEAD + 1 + binlog::MAX_VARINT + sizeof(message)];
+            binlog::DeltaState state;
+            uint64_t crashSequence = sequence + 1;
+            binlog::encodeHeader(record, state, includeDate, micros, crashSequence);
+            size_t size = binlog::HEADER_SIZE;
+            uint8_t args[1 + binlog::MAX_VARINT + sizeof(message)];
+            size_t argsSize = 0;
+            args[argsSize++] = static_cast<uint8_t>(binlog::ArgTag::STRING);
+            argsSize += binlog::putVarint(args + argsSize, messageSize);
+            std::memcpy(args + argsSize, message, messageSize);
+            argsSize += messageSize;
+            size += binlog::encodeRecordHead(record + size, state, crashSequence, micros,
+                                             static_cast<uint8_t>(LOG_FATAL), argsSize);
+            std::memcpy(record + size, args, argsSize);
+            size += argsSize;
+            sink->drainOnCrash(reinterpret_cast<const char*>(record), size);
+        } else if (sink) {
+            sink->drainOnCrash(line, lineSize);
+        }
+        if (LOG_FATAL >= consoleThreshold) {
+            sigsafe::writeAll(STDOUT_FILENO, line, lineSize);
+        }
+    }
+
+    /**
+     * @brief Writes the flight recorder to <prefix>_<pid>.ulog; async-signal-safe.
+     */
+    void dumpFlightRecorderOnCrash()
+    {
+        if (!flightRecorder.isEnabled()) return;
+        char path[sizeof(crashDumpPrefix) + 32];
+        size_t length = std::strlen(crashDumpPrefix);
+        std::memcpy(path, crashDumpPrefix, length);
+        path[length++] = '_';
+        length += sigsafe::putDecimal(path + length, static_cast<uint64_t>(::getpid()));
+        std::memcpy(path + length, ".ulog", 6);
+
+        int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return;
+        flightRecorder.dump(fd, includeDate);
+        ::close(fd);
+    }
+#endif
+
+#ifndef _WIN32
+    /**
+     * @brief Sets what a forked child does with the log file (PER_PROCESS by default).
+     *
+     * SAME_FILE switches this process to FileIoMode::SHARED right away,
+     * reopening the current file; the fork handlers themselves never touch
+     * the parent's file.
+     */
+    void setForkFilePolicy(ForkFilePolicy policy)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        forkFilePolicy = policy;
+        if (policy == ForkFilePolicy::SAME_FILE) {
+            shareFileUnsafe();
+        }
+    }
+
+    /**
+     * @brief Takes every lock of the logger before fork(), so the child gets them in a known state.
+     *
+     * Buffered records are written out first; otherwise parent and child
+     * would both write them.
+     */
+    void prepareFork()
+    {
+        logMutex.lock();
+        if (logFile && logFile->isOpen()) {
+            logFile->flush();
+            unflushedBytes = 0;
+            unflushedRecords = 0;
+        }
+        timestampMutex.lock();
+        commitMutex.lock();
+        worker.prepareFork();
+        compressor.prepareFork();
+    }
+
+    void parentAfterFork()
+    {
+        compressor.parentAfterFork();
+        worker.parentAfterFork();
+        commitMutex.unlock();
+        timestampMutex.unlock();
+        logMutex.unlock();
+    }
+
+    /**
+     * @brief Moves this process onto FileIoMode::SHARED, so that forked children can append to the same file.
+     *
+     * The other backends write at offsets they track themselves and trim the
+     * file to them on close, which would overwrite or cut off the child's
+     * records. An open file is reopened in place and a pre-opened next file
+     * is dropped, so rotation opens the next one shared as well.
+     */
+    void shareFileUnsafe()
+    {
+        if (fileOptions.ioMode == FileIoMode::SHARED || fileOptions.ringSize > 0) return;
+        fileOptions.ioMode = FileIoMode::SHARED;
+        if (!fileLoggingEnabled || !logFile) return;
+
+        if (nextFile) {
+            discardUnsafe(std::move(nextFile), segmentPath(filePath, segmentIndex + 1));
+        }
+        if (nextTimedFile) {
+            discardUnsafe(std::move(nextTimedFile), nextTimedPath);
+        }
+        // Pre-opens still in flight on the worker would arrive unshared
+        ++fileGeneration;
+        nextFileRequested = false;
+        nextTimedPath.clear();
+
+        // Closed before the reopen: its last writes must land before the shared descriptor's
+        syncRetiringUnsafe(*logFile);
+        logFile->close();
+        logFile = makeFileSink(currentPath, fileOptions);
+        fileLoggingEnabled = logFile->isOpen();
+        std::error_code ec;
+        auto existing = std::filesystem::file_size(currentPath, ec);
+        fileBytes = ec ? 0 : static_cast<size_t>(existing);
+        beginFileUnsafe();
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Brings the logger back in a forked child: threads restarted, file reopened per the fork policy.
+     */
+    void childAfterFork()
+    {
+        compressor.childAfterFork();
+        worker.childAfterFork();
+        // Durable records so far were the parent's to sync
+        new (&commitDone) std::condition_variable();
+        commitLeader = false;
+        durableCaptured = durableSynced = durableIssued;
+        commitMutex.unlock();
+        timestampMutex.unlock();
+        rearmTimersAfterForkUnsafe();
+        reopenAfterForkUnsafe();
+        armReopenPollUnsafe();
+        logMutex.unlock();
+    }
+
+    /**
+     * @brief Schedules again the periodic tasks the child's worker dropped.
+     */
+    void rearmTimersAfterForkUnsafe()
+    {
+        flushTimerArmed = false;
+        retentionTimerArmed = false;
+        reopenPollArmed = false;
+        signalPollArmed = false;
+        if (hasRule(flushPolicy, FlushPolicy::INTERVAL)) {
+            scheduleFlushTimerUnsafe();
+        }
+        if (retention.maxAge.count() > 0) {
+            scheduleRetentionCheckUnsafe();
+        }
+        if (signalLog.isEnabled()) {
+            scheduleSignalPollUnsafe();
+        }
+    }
+
+    /**
+     * @brief Replaces the inherited file sinks with files of the child's own.
+     *
+     * The inherited sinks are abandoned and leaked: closing them normally
+     * would flush, trim or sync a file the parent is still writing, and
+     * their locks and condition variables may belong to threads that do not
+     * exist in the child.
+     */
+    void reopenAfterForkUnsafe()
+    {
+        for (std::unique_ptr<FileSink>* sink : {&logFile, &nextFile, &nextTimedFile}) {
+            if (*sink) {
+                (*sink)->abandonAfterFork();
+                (void)sink->release();
+            }
+        }
+        // Pending opens and closes on the worker were the parent's, and the segment list is its to prune
+        ++fileGeneration;
+        nextFileRequested = false;
+        nextTimedPath.clear();
+        retainedSegments.clear();
+        if (!fileLoggingEnabled) return;
+
+        if (forkFilePolicy == ForkFilePolicy::CLOSE) {
+            fileLoggingEnabled = false;
+            updateCaptureFlags();
+            return;
+        }
+        if (forkFilePolicy == ForkFilePolicy::PER_PROCESS || ringFile) {
+            std::string suffix = "_" + std::to_string(::getpid());
+            auto withPid = [&suffix](const std::string& path) {
+                size_t dot = extensionPos(path);
+                return (dot == std::string::npos) ? path + suffix : path.substr(0, dot) + suffix + path.substr(dot);
+            };
+            fileName = fileName.empty() ? "log" + suffix + defaultExtension() : withPid(fileName);
+            filePath = withPid(filePath);
+            currentPath = filePath;
+            segmentIndex = 0;
+        } else {
+            // Whole-record O_APPEND writes are the only mode that shares a file with another writer
+            fileOptions.ioMode = FileIoMode::SHARED;
+        }
+        // A child that execs or never logs to the file leaves no file behind
+        fileOpenDeferred = true;
+    }
+
+    /**
+     * @brief Opens the file a forked child deferred, before its first file record.
+     */
+    void openDeferredFileUnsafe()
+    {
+        fileOpenDeferred = false;
+        logFile = makeFileSink(currentPath, fileOptions);
+        fileLoggingEnabled = logFile->isOpen();
+        std::error_code ec;
+        auto existing = std::filesystem::file_size(currentPath, ec);
+        fileBytes = ec ? 0 : static_cast<size_t>(existing);
+        beginFileUnsafe();
+        updateCaptureFlags();
+        if (fileLoggingEnabled && !ringFile && rotationInterval != RotationInterval::NONE) {
+            scheduleTimedRotationUnsafe(std::chrono::system_clock::now());
+        }
+    }
+#endif
+
+    /**
+     * @brief Enables file logging with optional custom filename.
+     */
+    void enableFileLogging(const std::string& filename = "")
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        
         if (!fileLoggingEnabled) {
+            auto now = std::chrono::system_clock::now();
             std::string logFilename;
             
             if (filename.empty()) {
-                std::ostringstream oss;
-                auto now = std::chrono::system_clock::now();
-                std::time_t t = std::chrono::system_clock::to_time_t(now);
-                std::tm tm;
-#ifdef _WIN32
-                localtime_s(&tm, &t);
-#else
-                localtime_r(&t, &tm);
-#endif
-                oss << "log_" << std::put_time(&tm, "%Y%m%d_%H%M%S") << ".txt";
-                logFilename = oss.str();
+                logFilename = timedPath("", std::chrono::system_clock::to_time_t(now), defaultExtension());
             } else {
                 logFilename = filename;
             }
             
-            logFile.open(logFilename, std::ios::out | std::ios::app);
-            fileLoggingEnabled = logFile.is_open();
+            logFile = makeFileSink(logFilename, fileOptions);
+            fileLoggingEnabled = logFile->isOpen();
+
+            std::error_code ec;
+            auto existing = std::filesystem::file_size(logFilename, ec);
+            fileBytes = ec ? 0 : static_cast<size_t>(existing);
+            fileName = filename;
+            filePath = logFilename;
+            currentPath = logFilename;
+            segmentIndex = 0;
+            nextFileRequested = false;
+            beginFileUnsafe();
+            updateCaptureFlags();
+
+            if (fileLoggingEnabled && !ringFile && rotationInterval != RotationInterval::NONE) {
+                scheduleTimedRotationUnsafe(now);
+            }
+#ifndef _WIN32
+            armReopenPollUnsafe();
+#endif
         }
     }
 
@@ -483,12 +2588,122 @@ struct LogBuffer
      */
     void disableFileLogging()
     {
-        std::lock_guard<std::mutex> lock(logMutex);
-        if (logFile.is_open()) {
-            logFile.flush();
-            logFile.close();
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            closeFileUnsafe();
+        }
+
+        // Let pending opens and closes finish
+        worker.waitIdle();
+    }
+
+    /**
+     * @brief Stops file logging; the file is flushed and closed on the worker.
+     */
+    void closeFileUnsafe()
+    {
+        fileOpenDeferred = false;
+        if (logFile) {
+            syncRetiringUnsafe(*logFile);
+            retireSegmentUnsafe(std::move(logFile), currentPath, fileBytes);
+        }
+        if (nextFile) {
+            discardUnsafe(std::move(nextFile), segmentPath(filePath, segmentIndex + 1));
         }
+        if (nextTimedFile) {
+            discardUnsafe(std::move(nextTimedFile), nextTimedPath);
+        }
+        ++fileGeneration;
+        nextFileRequested = false;
+        nextTimedPath.clear();
         fileLoggingEnabled = false;
+        updateCaptureFlags();
+    }
+
+    /**
+     * @brief Writes out everything pending and closes the file and record sinks, giving up after @p timeout.
+     *
+     * Signal-log records, buffered file data and the record sink queues all
+     * drain against one deadline. Whatever is still stuck when it passes (a
+     * write to a hung disk, a collector that stopped reading) is abandoned and
+     * its records are counted as dropped; a WARNING on the console says so.
+     * The threads involved are left running, so a logger whose shutdown did
+     * not complete should not be destroyed; the global one never is.
+     * Afterwards the logger writes to the console only. Calling it again
+     * returns at once, and it is safe in atexit() and at_quick_exit() handlers.
+     */
+    ShutdownReport shutdown(std::chrono::milliseconds timeout = DEFAULT_SHUTDOWN_TIMEOUT)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        ShutdownReport report;
+        std::unique_lock<std::mutex> lock(logMutex, std::defer_lock);
+        if (!lockUntil(lock, deadline)) {
+            // A writer is stuck inside the file or a sink; nothing can be counted without the lock
+            report.complete = false;
+            return report;
+        }
+
+#ifndef _WIN32
+        drainSignalLogUnsafe();
+#endif
+        size_t fileRecords = logFile ? unflushedRecords : 0;
+        closeFileUnsafe();
+        std::vector<std::shared_ptr<RecordSink>> sinks;
+        for (const SinkEntry& entry : recordSinks) {
+            if (std::find(sinks.begin(), sinks.end(), entry.sink) == sinks.end()) {
+                sinks.push_back(entry.sink);
+            }
+        }
+        recordSinks.clear();
+        updateSinkThresholdUnsafe();
+        lock.unlock();
+
+        if (!worker.waitIdleUntil(deadline)) {
+            report.complete = false;
+            report.droppedRecords += fileRecords;
+        }
+        for (const std::shared_ptr<RecordSink>& sink : sinks) {
+            ShutdownReport sinkReport = sink->shutdown(deadline);
+            report.droppedRecords += sinkReport.droppedRecords;
+            if (!sinkReport.complete) {
+                report.complete = false;
+                // Destroying it would join a thread that is stuck
+                new std::shared_ptr<RecordSink>(sink);
+            }
+        }
+
+        if (report.droppedRecords > 0 && lock.try_lock()) {
+            setLevel(LOG_WARNING);
+            append("shutdown deadline passed, records dropped:");
+            append(report.droppedRecords);
+            printUnsafe();
+        }
+        return report;
+    }
+
+    /**
+     * @brief Sets the deadline of the shutdown the global logger runs at exit() and quick_exit().
+     */
+    void setExitShutdownTimeout(std::chrono::milliseconds timeout)
+    {
+        exitShutdownMillis.store(timeout.count(), std::memory_order_relaxed);
+    }
+
+    std::chrono::milliseconds exitShutdownTimeout() const
+    {
+        return std::chrono::milliseconds(exitShutdownMillis.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Locks @p lock, polling, unless @p deadline passes first.
+     */
+    static bool lockUntil(std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point deadline)
+    {
+        while (!lock.try_lock()) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
     }
 
     /**
@@ -496,14 +2711,135 @@ struct LogBuffer
      */
     ~LogBuffer()
     {
+        unregisterLogger(this);
+#ifndef _WIN32
+        LogBuffer* self = this;
+        crashLogger.compare_exchange_strong(self, nullptr);
+#endif
         disableFileLogging();
+        compressor.stop();
+        worker.stop();
     }
 };
 
+#ifndef _WIN32
+/**
+ * @brief Lets crashLogger drain its file and dump its flight recorder, then gives the signal its previous course.
+ */
+inline void crashSignalHandler(int signal, siginfo_t*, void*)
+{
+    LogBuffer* logger = crashLogger.exchange(nullptr);
+    if (logger) {
+        logger->handleCrashSignal(signal);
+    }
+    for (size_t i = 0; i < std::size(CRASH_SIGNALS); ++i) {
+        if (CRASH_SIGNALS[i] == signal) {
+            ::sigaction(signal, &crashPreviousActions[i], nullptr);
+        }
+    }
+    ::raise(signal);
+}
+#endif
+
+#ifndef _WIN32
+/**
+ * @brief Record sinks locked by forkPrepare(), each once even if several loggers share it.
+ */
+inline std::vector<RecordSink*> forkSinks;
+
+/**
+ * @brief pthread_atfork() prepare handler: takes the locks of every logger and record sink.
+ *
+ * A fork() while another thread held a logger lock would otherwise leave
+ * the lock held forever in the child.
+ */
+inline void forkPrepare()
+{
+    loggerRegistryMutex.lock();
+    forkSinks.clear();
+    for (LogBuffer* logger : loggerRegistry) {
+        logger->prepareFork();
+        for (const LogBuffer::SinkEntry& entry : logger->recordSinks) {
+            if (std::find(forkSinks.begin(), forkSinks.end(), entry.sink.get()) == forkSinks.end()) {
+                forkSinks.push_back(entry.sink.get());
+            }
+        }
+    }
+    for (RecordSink* sink : forkSinks) {
+        sink->prepareFork();
+    }
+}
+
+inline void forkParent()
+{
+    for (auto sink = forkSinks.rbegin(); sink != forkSinks.rend(); ++sink) {
+        (*sink)->parentAfterFork();
+    }
+    for (auto logger = loggerRegistry.rbegin(); logger != loggerRegistry.rend(); ++logger) {
+        (*logger)->parentAfterFork();
+    }
+    loggerRegistryMutex.unlock();
+}
+
+inline void forkChild()
+{
+    for (auto sink = forkSinks.rbegin(); sink != forkSinks.rend(); ++sink) {
+        (*sink)->childAfterFork();
+    }
+    for (auto logger = loggerRegistry.rbegin(); logger != loggerRegistry.rend(); ++logger) {
+        (*logger)->childAfterFork();
+    }
+    loggerRegistryMutex.unlock();
+}
+#endif
+
+/**
+ * @brief Adds @p logger to the registry; the first call installs the fork handlers.
+ */
+inline void registerLogger(LogBuffer* logger)
+{
+#ifndef _WIN32
+    static std::once_flag installed;
+    std::call_once(installed, [] { ::pthread_atfork(forkPrepare, forkParent, forkChild); });
+#endif
+    std::lock_guard<std::mutex> lock(loggerRegistryMutex);
+    loggerRegistry.push_back(logger);
+}
+
+inline void unregisterLogger(LogBuffer* logger)
+{
+    std::lock_guard<std::mutex> lock(loggerRegistryMutex);
+    std::erase(loggerRegistry, logger);
+}
+
+/**
+ * @brief Shuts the global logger down with its exit deadline; registered with atexit() and at_quick_exit().
+ */
+inline void shutdownGlobalLogger();
+
+/**
+ * @brief Creates the global instance, which is never destroyed.
+ *
+ * Objects destroyed during exit, in whatever order, may still log through
+ * it; once the exit handler has shut it down they get the console only.
+ */
+inline std::shared_ptr<LogBuffer>& makeGlobalLogger()
+{
+    auto* global = new std::shared_ptr<LogBuffer>(std::make_shared<LogBuffer>());
+    std::atexit(shutdownGlobalLogger);
+    std::at_quick_exit(shutdownGlobalLogger);
+    return *global;
+}
+
 /**
  * @brief Global instance.
  */
-inline std::shared_ptr<LogBuffer> log_local = std::make_shared<LogBuffer>();
+inline std::shared_ptr<LogBuffer>& log_local = makeGlobalLogger();
+
+inline void shutdownGlobalLogger()
+{
+    log_local->shutdown(log_local->exitShutdownTimeout());
+}
 
 /**
  * @brief Gets the global log buffer instance.
@@ -547,15 +2883,31 @@ inline void setLogger(std::shared_ptr<LogBuffer> logger)
 
 /**
  * @brief Thread-safe logging macro with automatic mutex protection.
+ *
+ * Records covered by the durability policy wait for the disk after the lock is released; a FATAL
+ * record writes its flight recorder dump there too.
  */
 #define LOG_PRINT(SEVERITY, ...)  \
     do { \
-        std::lock_guard<std::mutex> _log_guard(log_local->logMutex); \
-        log_local->setLevel(SEVERITY); \
-        __VA_ARGS__ \
-        log_local->printUnsafe(); \
+        PrintTicket _log_ticket; \
+        { \
+            std::lock_guard<std::mutex> _log_guard(log_local->logMutex); \
+            log_local->setLevel(SEVERITY); \
+            __VA_ARGS__ \
+            _log_ticket = log_local->printUnsafe(); \
+        } \
+        log_local->completePrint(_log_ticket); \
     } while(0)
 
+#ifndef _WIN32
+/**
+ * @brief Async-signal-safe record, e.g. LOG_SIGNAL(LOG_WARNING, "SIGTERM from pid", info->si_pid);
+ * see LogBuffer::enableSignalLog().
+ */
+#define LOG_SIGNAL(SEVERITY, ...) \
+    log_local->logSignalSafe(SEVERITY, __VA_ARGS__)
+#endif
+
 /**
  * @brief Enhanced logger initialization with flush policy.
  */
@@ -590,6 +2942,12 @@ inline void setLogger(std::shared_ptr<LogBuffer> logger)
         log_local->disableFileLogging(); \
     } while(0)
 
+/**
+ * @brief Drains and closes the outputs within TIMEOUT_MS milliseconds; yields a ShutdownReport.
+ */
+#define LOG_SHUTDOWN(TIMEOUT_MS) \
+    log_local->shutdown(std::chrono::milliseconds(TIMEOUT_MS))
+
 /**
  * @brief Manual flush macro.
  */
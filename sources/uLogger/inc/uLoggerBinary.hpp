@@ -0,0 +1,493 @@
+#ifndef ULOGGER_BINARY_H
+#define ULOGGER_BINARY_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Compact binary log format.
+ *
+ * A file is a sequence of entries, each introduced by a varint length.
+ * Length 0 marks a header (magic, flags, base timestamp, base sequence)
+ * that resets the delta state, so rotated segments and appended sessions
+ * decode on their own. Any other length is a record:
+ *
+ *     varint  sequence delta
+ *     zigzag  timestamp delta in microseconds
+ *     byte    level (bit 7 set when the record was truncated)
+ *     ...     typed arguments: tag byte + payload, up to the record end
+ *
+ * Arguments keep the type chosen by the LOG_xxx macro and are rendered to
+ * the same text LogBuffer::append() would have produced.
+ */
+namespace binlog {
+
+constexpr char MAGIC[8] = { 'U', 'L', 'O', 'G', 'B', 'I', 'N', '1' };
+constexpr uint8_t FLAG_INCLUDE_DATE = 0x01;
+constexpr uint8_t LEVEL_TRUNCATED = 0x80;
+constexpr size_t HEADER_SIZE = 1 + sizeof(MAGIC) + 1 + 8 + 8;
+constexpr size_t MAX_VARINT = 10;
+
+/**
+ * @brief Argument type tags, one per LOG_xxx flavour.
+ */
+enum class ArgTag : uint8_t {
+    STRING = 1,
+    BOOL,
+    CHAR,
+    INT8,
+    INT16,
+    INT32,
+    INT64,
+    UINT8,
+    UINT16,
+    UINT32,
+    UINT64,
+    SIZE,
+    HEX8,
+    HEX16,
+    HEX32,
+    HEX64,
+    HEXSIZE,
+    FLOAT,
+    DOUBLE,
+    POINTER
+};
+
+inline size_t putVarint(uint8_t* out, uint64_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+/**
+ * @brief Reads a varint; returns the bytes consumed, or 0 if the input ends first.
+ */
+inline size_t getVarint(const uint8_t* in, size_t size, uint64_t& value)
+{
+    value = 0;
+    for (size_t n = 0; n < size && n < MAX_VARINT; ++n) {
+        value |= static_cast<uint64_t>(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief Returns the tag used for an integral argument of type T.
+ */
+template<typename T>
+constexpr ArgTag integerTag(bool hex)
+{
+    if (std::is_same<T, size_t>::value) {
+        return hex ? ArgTag::HEXSIZE : ArgTag::SIZE;
+    }
+    if (hex) {
+        return sizeof(T) == 1 ? ArgTag::HEX8 : sizeof(T) == 2 ? ArgTag::HEX16 :
+               sizeof(T) == 4 ? ArgTag::HEX32 : ArgTag::HEX64;
+    }
+    if (std::is_signed<T>::value) {
+        return sizeof(T) == 1 ? ArgTag::INT8 : sizeof(T) == 2 ? ArgTag::INT16 :
+               sizeof(T) == 4 ? ArgTag::INT32 : ArgTag::INT64;
+    }
+    return sizeof(T) == 1 ? ArgTag::UINT8 : sizeof(T) == 2 ? ArgTag::UINT16 :
+           sizeof(T) == 4 ? ArgTag::UINT32 : ArgTag::UINT64;
+}
+
+/**
+ * @brief Fixed-capacity buffer of typed arguments for one record.
+ */
+template<size_t CAPACITY>
+struct ArgBuffer
+{
+    uint8_t data[CAPACITY];
+    size_t size = 0;
+    bool overflow = false;
+
+    void clear()
+    {
+        size = 0;
+        overflow = false;
+    }
+
+    bool reserve(size_t bytes)
+    {
+        // Once an argument did not fit, the ones after it are dropped, as in the text buffer
+        if (overflow || size + bytes > CAPACITY) {
+            overflow = true;
+            return false;
+        }
+        return true;
+    }
+
+    void putTagged(ArgTag tag, uint64_t value)
+    {
+        if (!reserve(1 + MAX_VARINT)) return;
+        data[size++] = static_cast<uint8_t>(tag);
+        size += putVarint(data + size, value);
+    }
+
+    void putString(const char* text, size_t length)
+    {
+        if (!reserve(1 + MAX_VARINT + 1)) return;
+        // A string that does not fit keeps its beginning, as in the text buffer
+        size_t room = CAPACITY - size - 1 - MAX_VARINT;
+        if (length > room) {
+            length = room;
+            overflow = true;
+        }
+        data[size++] = static_cast<uint8_t>(ArgTag::STRING);
+        size += putVarint(data + size, length);
+        std::memcpy(data + size, text, length);
+        size += length;
+    }
+
+    void putByte(ArgTag tag, uint8_t value)
+    {
+        if (!reserve(2)) return;
+        data[size++] = static_cast<uint8_t>(tag);
+        data[size++] = value;
+    }
+
+    template<typename T>
+    void putInteger(T value, bool hex)
+    {
+        constexpr bool SIGNED = std::is_signed<T>::value && !std::is_same<T, size_t>::value;
+        ArgTag tag = integerTag<T>(hex);
+        if (SIGNED && !hex) {
+            putTagged(tag, zigzag(static_cast<int64_t>(value)));
+        } else {
+            putTagged(tag, static_cast<uint64_t>(static_cast<typename std::make_unsigned<T>::type>(value)));
+        }
+    }
+
+    template<typename T>
+    void putFloat(T value)
+    {
+        constexpr size_t BYTES = sizeof(T) == sizeof(float) ? 4 : 8;
+        if (!reserve(1 + BYTES)) return;
+        data[size++] = static_cast<uint8_t>(BYTES == 4 ? ArgTag::FLOAT : ArgTag::DOUBLE);
+        if (BYTES == 4) {
+            float f = static_cast<float>(value);
+            std::memcpy(data + size, &f, 4);
+        } else {
+            double d = static_cast<double>(value);
+            std::memcpy(data + size, &d, 8);
+        }
+        size += BYTES;
+    }
+};
+
+/**
+ * @brief Delta state shared by the encoder and decoder of one file.
+ */
+struct DeltaState {
+    int64_t micros = 0;
+    uint64_t sequence = 0;
+};
+
+/**
+ * @brief Writes a header entry (HEADER_SIZE bytes) to @p out and resets @p state to its base values.
+ */
+inline void encodeHeader(uint8_t* out, DeltaState& state, bool includeDate, int64_t micros, uint64_t sequence)
+{
+    out[0] = 0;
+    std::memcpy(out + 1, MAGIC, sizeof(MAGIC));
+    out[9] = includeDate ? FLAG_INCLUDE_DATE : 0;
+    for (int i = 0; i < 8; ++i) {
+        out[10 + i] = static_cast<uint8_t>(static_cast<uint64_t>(micros) >> (8 * i));
+        out[18 + i] = static_cast<uint8_t>(sequence >> (8 * i));
+    }
+    state.micros = micros;
+    state.sequence = sequence;
+}
+
+/**
+ * @brief Appends a header entry and resets @p state to its base values.
+ */
+inline void encodeHeader(std::string& out, DeltaState& state, bool includeDate, int64_t micros, uint64_t sequence)
+{
+    uint8_t header[HEADER_SIZE];
+    encodeHeader(header, state, includeDate, micros, sequence);
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+constexpr size_t MAX_RECORD_HEAD = 4 * MAX_VARINT + 1;
+
+/**
+ * @brief Writes the part of a record entry before its arguments; returns its size.
+ *
+ * Needs no allocation, so it is also usable from a signal handler.
+ */
+inline size_t encodeRecordHead(uint8_t* out, DeltaState& state, uint64_t sequence, int64_t micros,
+                               uint8_t level, size_t argsSize)
+{
+    uint8_t head[3 * MAX_VARINT + 1];
+    size_t n = putVarint(head, sequence - state.sequence);
+    n += putVarint(head + n, zigzag(micros - state.micros));
+    head[n++] = level;
+
+    size_t lengthSize = putVarint(out, n + argsSize);
+    std::memcpy(out + lengthSize, head, n);
+
+    state.micros = micros;
+    state.sequence = sequence;
+    return lengthSize + n;
+}
+
+/**
+ * @brief Appends one record entry.
+ */
+inline void encodeRecord(std::string& out, DeltaState& state, uint64_t sequence, int64_t micros,
+                         uint8_t level, const uint8_t* args, size_t argsSize)
+{
+    uint8_t head[MAX_RECORD_HEAD];
+    size_t n = encodeRecordHead(head, state, sequence, micros, level, argsSize);
+    out.append(reinterpret_cast<const char*>(head), n);
+    out.append(reinterpret_cast<const char*>(args), argsSize);
+}
+
+/**
+ * @brief Renders encoded arguments to the text the append() path produces.
+ * @return False if the arguments are malformed (text rendered so far is kept).
+ */
+inline bool renderArgs(const uint8_t* data, size_t size, std::string& out)
+{
+    char text[64];
+    size_t pos = 0;
+
+    while (pos < size) {
+        ArgTag tag = static_cast<ArgTag>(data[pos++]);
+        uint64_t value = 0;
+        int written = 0;
+
+        switch (tag) {
+            case ArgTag::STRING: {
+                size_t n = getVarint(data + pos, size - pos, value);
+                if (n == 0 || value > size - pos - n) return false;
+                pos += n;
+                out.append(reinterpret_cast<const char*>(data + pos), static_cast<size_t>(value));
+                out.push_back(' ');
+                pos += static_cast<size_t>(value);
+                continue;
+            }
+            case ArgTag::BOOL:
+            case ArgTag::CHAR:
+                if (pos >= size) return false;
+                if (tag == ArgTag::BOOL) {
+                    out.append(data[pos] ? "true " : "false ");
+                } else {
+                    out.push_back(static_cast<char>(data[pos]));
+                    out.push_back(' ');
+                }
+                ++pos;
+                continue;
+            case ArgTag::FLOAT:
+            case ArgTag::DOUBLE: {
+                double d;
+                if (tag == ArgTag::FLOAT) {
+                    float f;
+                    if (size - pos < 4) return false;
+                    std::memcpy(&f, data + pos, 4);
+                    d = f;
+                    pos += 4;
+                } else {
+                    if (size - pos < 8) return false;
+                    std::memcpy(&d, data + pos, 8);
+                    pos += 8;
+                }
+                std::string number(static_cast<size_t>(std::snprintf(nullptr, 0, "%.8f ", d)), '\0');
+                std::snprintf(&number[0], number.size() + 1, "%.8f ", d);
+                out.append(number);
+                continue;
+            }
+            default:
+                break;
+        }
+
+        size_t n = getVarint(data + pos, size - pos, value);
+        if (n == 0) return false;
+        pos += n;
+
+        switch (tag) {
+            case ArgTag::INT8:
+            case ArgTag::INT16:
+            case ArgTag::INT32:
+            case ArgTag::INT64:
+                written = std::snprintf(text, sizeof(text), "%lld ", static_cast<long long>(unzigzag(value)));
+                break;
+            case ArgTag::UINT8:
+            case ArgTag::UINT16:
+            case ArgTag::UINT32:
+            case ArgTag::UINT64:
+                written = std::snprintf(text, sizeof(text), "%llu ", static_cast<unsigned long long>(value));
+                break;
+            case ArgTag::SIZE:
+                written = std::snprintf(text, sizeof(text), "%zu ", static_cast<size_t>(value));
+                break;
+            case ArgTag::HEX8:
+            case ArgTag::HEX16:
+            case ArgTag::HEX32:
+            case ArgTag::HEX64:
+                written = std::snprintf(text, sizeof(text), "0x%llX ", static_cast<unsigned long long>(value));
+                break;
+            case ArgTag::HEXSIZE:
+                written = std::snprintf(text, sizeof(text), "0x%zX ", static_cast<size_t>(value));
+                break;
+            case ArgTag::POINTER:
+                written = std::snprintf(text, sizeof(text), "%p ", reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                break;
+            default:
+                return false;
+        }
+        out.append(text, static_cast<size_t>(written));
+    }
+    return true;
+}
+
+/**
+ * @brief One decoded record; @p args points into the decoder's buffer.
+ */
+struct Record {
+    uint64_t sequence = 0;
+    int64_t micros = 0;
+    uint8_t level = 0;
+    bool truncated = false;
+    const uint8_t* args = nullptr;
+    size_t argsSize = 0;
+};
+
+/**
+ * @brief Incremental decoder: feed bytes in any chunking, get whole records back.
+ */
+struct StreamDecoder
+{
+    std::string pending;
+    size_t offset = 0;
+    DeltaState state;
+    bool includeDate = true;
+    bool sawHeader = false;
+    bool corrupt = false;
+    bool skipUntilHeader = false;   // drop records before the first header (ring files)
+    uint64_t skipped = 0;
+
+    void feed(const char* data, size_t size)
+    {
+        if (offset > 0 && offset == pending.size()) {
+            pending.clear();
+            offset = 0;
+        } else if (offset > (1u << 20)) {
+            pending.erase(0, offset);
+            offset = 0;
+        }
+        pending.append(data, size);
+    }
+
+    /**
+     * @brief Decodes the next record; false when more input is needed (or on corruption).
+     */
+    bool next(Record& record)
+    {
+        while (!corrupt) {
+            const uint8_t* in = reinterpret_cast<const uint8_t*>(pending.data()) + offset;
+            size_t available = pending.size() - offset;
+            uint64_t length;
+            size_t n = getVarint(in, available, length);
+            if (n == 0) {
+                corrupt = available >= MAX_VARINT;
+                return false;
+            }
+
+            if (length == 0) {
+                if (available < HEADER_SIZE) return false;
+                if (std::memcmp(in + 1, MAGIC, sizeof(MAGIC)) != 0) {
+                    corrupt = true;
+                    return false;
+                }
+                uint64_t micros = 0, sequence = 0;
+                for (int i = 0; i < 8; ++i) {
+                    micros |= static_cast<uint64_t>(in[10 + i]) << (8 * i);
+                    sequence |= static_cast<uint64_t>(in[18 + i]) << (8 * i);
+                }
+                includeDate = (in[9] & FLAG_INCLUDE_DATE) != 0;
+                state.micros = static_cast<int64_t>(micros);
+                state.sequence = sequence;
+                sawHeader = true;
+                offset += HEADER_SIZE;
+                continue;
+            }
+
+            if (length > available - n) return false;
+            if (!sawHeader) {
+                if (!skipUntilHeader) {
+                    corrupt = true;
+                    return false;
+                }
+                offset += n + static_cast<size_t>(length);
+                ++skipped;
+                continue;
+            }
+
+            const uint8_t* body = in + n;
+            uint64_t sequenceDelta, timeDelta;
+            size_t a = getVarint(body, static_cast<size_t>(length), sequenceDelta);
+            size_t b = a ? getVarint(body + a, static_cast<size_t>(length) - a, timeDelta) : 0;
+            if (a == 0 || b == 0 || a + b >= length) {
+                corrupt = true;
+                return false;
+            }
+
+            state.sequence += sequenceDelta;
+            state.micros += unzigzag(timeDelta);
+            record.sequence = state.sequence;
+            record.micros = state.micros;
+            record.level = body[a + b] & static_cast<uint8_t>(~LEVEL_TRUNCATED);
+            record.truncated = (body[a + b] & LEVEL_TRUNCATED) != 0;
+            record.args = body + a + b + 1;
+            record.argsSize = static_cast<size_t>(length) - a - b - 1;
+            offset += n + static_cast<size_t>(length);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief True if input ended in the middle of an entry.
+     */
+    bool hasPartial() const
+    {
+        return offset < pending.size();
+    }
+};
+
+/**
+ * @brief True if @p data starts with a binary log header.
+ */
+inline bool isBinaryLog(const char* data, size_t size)
+{
+    return size >= 1 + sizeof(MAGIC) && data[0] == 0 && std::memcmp(data + 1, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+} // namespace binlog
+
+#endif // ULOGGER_BINARY_H
@@ -0,0 +1,538 @@
+#ifndef ULOGGER_CODEC_H
+#define ULOGGER_CODEC_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef ULOGGER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @brief Compression applied to closed log segments.
+ */
+enum class CompressionCodec {
+    NONE,             /**< Keep segments as plain text. */
+    AUTO,             /**< gzip when zlib was found at configure time, LZ4 otherwise. */
+    LZ4,              /**< Built-in LZ4 frame encoder (.lz4, readable by the lz4 tool). */
+    GZIP              /**< zlib gzip stream (.gz); falls back to LZ4 without zlib. */
+};
+
+/**
+ * @brief Minimal LZ4 block and frame codec.
+ *
+ * The encoder is a single-pass greedy matcher: it trades some ratio for
+ * speed, which suits repetitive log text. Frames use independent blocks
+ * with optional xxHash32 block checksums, so every frame (and every block
+ * in it) can be decoded on its own and the output is accepted by the
+ * reference lz4 tool.
+ */
+namespace lz4 {
+
+constexpr uint32_t FRAME_MAGIC = 0x184D2204;
+constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+constexpr uint32_t UNCOMPRESSED_FLAG = 0x80000000U;
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MF_LIMIT = 12;
+constexpr unsigned HASH_LOG = 13;
+
+inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void writeLE32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+inline uint32_t readLE32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/**
+ * @brief xxHash32, used for the frame header and block checksums.
+ */
+inline uint32_t xxh32(const uint8_t* data, size_t size, uint32_t seed = 0)
+{
+    constexpr uint32_t P1 = 2654435761U, P2 = 2246822519U, P3 = 3266489917U, P4 = 668265263U, P5 = 374761393U;
+    auto rotl = [](uint32_t x, int r) { return (x << r) | (x >> (32 - r)); };
+    auto round = [&](uint32_t acc, uint32_t input) { return rotl(acc + input * P2, 13) * P1; };
+
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint32_t h;
+
+    if (size >= 16) {
+        uint32_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+        while (p + 16 <= end) {
+            v1 = round(v1, readLE32(p));
+            v2 = round(v2, readLE32(p + 4));
+            v3 = round(v3, readLE32(p + 8));
+            v4 = round(v4, readLE32(p + 12));
+            p += 16;
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    } else {
+        h = seed + P5;
+    }
+
+    h += static_cast<uint32_t>(size);
+    while (p + 4 <= end) {
+        h = rotl(h + readLE32(p) * P3, 17) * P4;
+        p += 4;
+    }
+    while (p < end) {
+        h = rotl(h + (*p++) * P5, 11) * P1;
+    }
+
+    h ^= h >> 15;
+    h *= P2;
+    h ^= h >> 13;
+    h *= P3;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief Worst-case compressed size of @p size input bytes.
+ */
+inline size_t compressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+/**
+ * @brief Compresses one block; @p destination must hold compressBound(size) bytes.
+ * @return Compressed size.
+ */
+inline size_t compressBlock(const char* source, size_t size, char* destination)
+{
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(source);
+    uint8_t* op = reinterpret_cast<uint8_t*>(destination);
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + size;
+
+    auto emitLength = [&op](size_t length) {
+        while (length >= 255) {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = static_cast<uint8_t>(length);
+    };
+
+    auto emitSequence = [&](const uint8_t* literalEnd, size_t matchLength, size_t offset) {
+        size_t literals = static_cast<size_t>(literalEnd - anchor);
+        uint8_t* token = op++;
+        *token = static_cast<uint8_t>((literals >= 15 ? 15 : literals) << 4);
+        if (literals >= 15) {
+            emitLength(literals - 15);
+        }
+        std::memcpy(op, anchor, literals);
+        op += literals;
+        if (matchLength == 0) return;   // final literal run
+
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        size_t code = matchLength - MIN_MATCH;
+        *token |= static_cast<uint8_t>(code >= 15 ? 15 : code);
+        if (code >= 15) {
+            emitLength(code - 15);
+        }
+    };
+
+    if (size > MF_LIMIT) {
+        std::vector<uint32_t> table(size_t(1) << HASH_LOG, 0);
+        const uint8_t* matchStartLimit = end - MF_LIMIT;
+        const uint8_t* matchEndLimit = end - LAST_LITERALS;
+
+        while (ip < matchStartLimit) {
+            uint32_t sequence = read32(ip);
+            uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_LOG);
+            const uint8_t* ref = src + table[hash];
+            table[hash] = static_cast<uint32_t>(ip - src);
+
+            if (ref >= ip || ip - ref > 65535 || read32(ref) != sequence) {
+                // Skip faster through data that does not compress
+                ip += 1 + (static_cast<size_t>(ip - anchor) >> 6);
+                continue;
+            }
+
+            const uint8_t* matchEnd = ip + MIN_MATCH;
+            const uint8_t* refEnd = ref + MIN_MATCH;
+            while (matchEnd < matchEndLimit && *matchEnd == *refEnd) {
+                ++matchEnd;
+                ++refEnd;
+            }
+
+            emitSequence(ip, static_cast<size_t>(matchEnd - ip), static_cast<size_t>(ip - ref));
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    emitSequence(end, 0, 0);
+    return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(destination));
+}
+
+/**
+ * @brief Decompresses one block into at most @p capacity bytes.
+ * @return Decompressed size, or -1 if the block is malformed.
+ */
+inline long decompressBlock(const char* source, size_t size, char* destination, size_t capacity)
+{
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(source);
+    const uint8_t* end = ip + size;
+    uint8_t* op = reinterpret_cast<uint8_t*>(destination);
+    uint8_t* opStart = op;
+    uint8_t* opEnd = op + capacity;
+
+    auto readLength = [&](size_t& length) {
+        uint8_t b;
+        do {
+            if (ip >= end) return false;
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) return -1;
+        if (literals > static_cast<size_t>(end - ip) || literals > static_cast<size_t>(opEnd - op)) return -1;
+        std::memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip == end) break;   // last sequence has no match
+
+        if (end - ip < 2) return -1;
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(matchLength)) return -1;
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - opStart) ||
+            matchLength > static_cast<size_t>(opEnd - op)) {
+            return -1;
+        }
+        // Byte copy: matches may overlap their own output
+        const uint8_t* ref = op - offset;
+        for (size_t i = 0; i < matchLength; ++i) {
+            op[i] = ref[i];
+        }
+        op += matchLength;
+    }
+    return static_cast<long>(op - opStart);
+}
+
+/**
+ * @brief Appends a frame header for 64 KiB independent blocks.
+ */
+inline void appendFrameHeader(std::vector<char>& out, bool blockChecksums)
+{
+    uint8_t header[7];
+    writeLE32(header, FRAME_MAGIC);
+    header[4] = static_cast<uint8_t>(0x60 | (blockChecksums ? 0x10 : 0));   // version 01, independent blocks
+    header[5] = 0x40;                                                        // 64 KiB max block
+    header[6] = static_cast<uint8_t>((xxh32(header + 4, 2) >> 8) & 0xFF);
+    out.insert(out.end(), header, header + sizeof(header));
+}
+
+/**
+ * @brief Appends one block (at most MAX_BLOCK_SIZE input bytes) to a frame.
+ *
+ * Stored uncompressed when compression would not make it smaller.
+ */
+inline void appendFrameBlock(std::vector<char>& out, const char* data, size_t size, bool blockChecksum)
+{
+    size_t start = out.size();
+    out.resize(start + 4 + compressBound(size) + 4);
+    char* payload = out.data() + start + 4;
+
+    size_t compressed = compressBlock(data, size, payload);
+    uint32_t header = static_cast<uint32_t>(compressed);
+    if (compressed >= size) {
+        std::memcpy(payload, data, size);
+        compressed = size;
+        header = static_cast<uint32_t>(size) | UNCOMPRESSED_FLAG;
+    }
+    writeLE32(reinterpret_cast<uint8_t*>(out.data() + start), header);
+
+    size_t used = start + 4 + compressed;
+    if (blockChecksum) {
+        writeLE32(reinterpret_cast<uint8_t*>(out.data() + used),
+                  xxh32(reinterpret_cast<const uint8_t*>(payload), compressed));
+        used += 4;
+    }
+    out.resize(used);
+}
+
+/**
+ * @brief Appends the end mark that closes a frame.
+ */
+inline void appendFrameEnd(std::vector<char>& out)
+{
+    out.insert(out.end(), 4, '\0');
+}
+
+/**
+ * @brief Builds a complete single-block frame, the unit written by streaming sinks.
+ */
+inline void appendBlockFrame(std::vector<char>& out, const char* data, size_t size)
+{
+    appendFrameHeader(out, true);
+    appendFrameBlock(out, data, size, true);
+    appendFrameEnd(out);
+}
+
+/**
+ * @brief Outcome of decoding a stream of LZ4 frames.
+ */
+struct FrameReadResult {
+    uint64_t frames = 0;        /**< Complete frames decoded. */
+    uint64_t bytes = 0;         /**< Decompressed bytes delivered. */
+    bool truncated = false;     /**< The stream ended inside a frame (e.g. after a crash). */
+    bool corrupt = false;       /**< Bad magic, header or checksum; decoding stopped there. */
+};
+
+/**
+ * @brief Decodes consecutive frames with independent blocks, passing each block to @p output.
+ *
+ * Blocks are delivered as soon as they verify, so everything before a torn
+ * or damaged frame is recovered.
+ */
+inline FrameReadResult decompressFrames(std::FILE* in, const std::function<void(const char*, size_t)>& output)
+{
+    FrameReadResult result;
+    std::vector<char> packed;
+    std::vector<char> plain;
+
+    auto readExact = [in](void* data, size_t size) {
+        return std::fread(data, 1, size, in) == size;
+    };
+
+    for (;;) {
+        uint8_t magic[4];
+        size_t got = std::fread(magic, 1, sizeof(magic), in);
+        if (got == 0) return result;
+        if (got < sizeof(magic)) {
+            result.truncated = true;
+            return result;
+        }
+
+        uint32_t value = readLE32(magic);
+        if ((value & 0xFFFFFFF0U) == 0x184D2A50U) {
+            // Skippable frame
+            uint8_t length[4];
+            if (!readExact(length, sizeof(length)) || std::fseek(in, readLE32(length), SEEK_CUR) != 0) {
+                result.truncated = true;
+                return result;
+            }
+            continue;
+        }
+        if (value != FRAME_MAGIC) {
+            result.corrupt = true;
+            return result;
+        }
+
+        uint8_t descriptor[15];
+        if (!readExact(descriptor, 2)) {
+            result.truncated = true;
+            return result;
+        }
+        uint8_t flags = descriptor[0];
+        size_t descriptorSize = 2 + ((flags & 0x08) ? 8 : 0) + ((flags & 0x01) ? 4 : 0);
+        if (!readExact(descriptor + 2, descriptorSize - 2 + 1)) {
+            result.truncated = true;
+            return result;
+        }
+        unsigned blockSizeId = (descriptor[1] >> 4) & 0x07;
+        if ((flags >> 6) != 1 || !(flags & 0x20) || blockSizeId < 4 ||
+            descriptor[descriptorSize] != ((xxh32(descriptor, descriptorSize) >> 8) & 0xFF)) {
+            result.corrupt = true;   // also rejects linked blocks, which this decoder does not support
+            return result;
+        }
+        bool blockChecksums = (flags & 0x10) != 0;
+        bool contentChecksum = (flags & 0x04) != 0;
+        size_t maxBlock = size_t(1) << (8 + 2 * blockSizeId);
+        plain.resize(maxBlock);
+
+        for (;;) {
+            uint8_t header[4];
+            if (!readExact(header, sizeof(header))) {
+                result.truncated = true;
+                return result;
+            }
+            uint32_t blockHeader = readLE32(header);
+            if (blockHeader == 0) {
+                if (contentChecksum && !readExact(header, sizeof(header))) {
+                    result.truncated = true;
+                    return result;
+                }
+                break;
+            }
+
+            size_t size = blockHeader & ~UNCOMPRESSED_FLAG;
+            if (size > maxBlock) {
+                result.corrupt = true;
+                return result;
+            }
+            packed.resize(size);
+            if (!readExact(packed.data(), size)) {
+                result.truncated = true;
+                return result;
+            }
+            if (blockChecksums) {
+                if (!readExact(header, sizeof(header))) {
+                    result.truncated = true;
+                    return result;
+                }
+                if (readLE32(header) != xxh32(reinterpret_cast<const uint8_t*>(packed.data()), size)) {
+                    result.corrupt = true;
+                    return result;
+                }
+            }
+
+            if (blockHeader & UNCOMPRESSED_FLAG) {
+                output(packed.data(), size);
+                result.bytes += size;
+                continue;
+            }
+            long decoded = decompressBlock(packed.data(), size, plain.data(), plain.size());
+            if (decoded < 0) {
+                result.corrupt = true;
+                return result;
+            }
+            output(plain.data(), static_cast<size_t>(decoded));
+            result.bytes += static_cast<uint64_t>(decoded);
+        }
+        ++result.frames;
+    }
+}
+
+/**
+ * @brief Compresses a whole file into a single LZ4 frame.
+ * @return False if either file could not be accessed.
+ */
+inline bool compressFile(const std::string& inputPath, const std::string& outputPath)
+{
+    std::FILE* in = std::fopen(inputPath.c_str(), "rb");
+    if (!in) return false;
+    std::FILE* out = std::fopen(outputPath.c_str(), "wb");
+    if (!out) {
+        std::fclose(in);
+        return false;
+    }
+
+    std::vector<char> block(MAX_BLOCK_SIZE);
+    std::vector<char> frame;
+    appendFrameHeader(frame, false);
+
+    bool ok = true;
+    size_t got;
+    while ((got = std::fread(block.data(), 1, block.size(), in)) > 0) {
+        appendFrameBlock(frame, block.data(), got, false);
+        ok = ok && std::fwrite(frame.data(), 1, frame.size(), out) == frame.size();
+        frame.clear();
+    }
+    appendFrameEnd(frame);
+    ok = ok && std::fwrite(frame.data(), 1, frame.size(), out) == frame.size() && !std::ferror(in);
+
+    std::fclose(in);
+    ok = std::fclose(out) == 0 && ok;
+    return ok;
+}
+
+} // namespace lz4
+
+#ifdef ULOGGER_HAVE_ZLIB
+
+namespace gzip {
+
+/**
+ * @brief Compresses a whole file into a gzip stream.
+ * @return False if either file could not be accessed.
+ */
+inline bool compressFile(const std::string& inputPath, const std::string& outputPath)
+{
+    std::FILE* in = std::fopen(inputPath.c_str(), "rb");
+    if (!in) return false;
+    gzFile out = gzopen(outputPath.c_str(), "wb6");
+    if (!out) {
+        std::fclose(in);
+        return false;
+    }
+
+    std::vector<char> block(64 * 1024);
+    bool ok = true;
+    size_t got;
+    while (ok && (got = std::fread(block.data(), 1, block.size(), in)) > 0) {
+        ok = gzwrite(out, block.data(), static_cast<unsigned>(got)) == static_cast<int>(got);
+    }
+    ok = ok && !std::ferror(in);
+
+    std::fclose(in);
+    ok = gzclose(out) == Z_OK && ok;
+    return ok;
+}
+
+} // namespace gzip
+
+#endif // ULOGGER_HAVE_ZLIB
+
+/**
+ * @brief Resolves AUTO and unavailable codecs to the one actually used.
+ */
+inline CompressionCodec effectiveCodec(CompressionCodec codec)
+{
+#ifdef ULOGGER_HAVE_ZLIB
+    return codec == CompressionCodec::AUTO ? CompressionCodec::GZIP : codec;
+#else
+    return (codec == CompressionCodec::AUTO || codec == CompressionCodec::GZIP) ? CompressionCodec::LZ4 : codec;
+#endif
+}
+
+/**
+ * @brief Compresses @p path into a sibling file with the codec's extension.
+ * @return Path of the compressed file, or an empty string on failure.
+ */
+inline std::string compressSegment(const std::string& path, CompressionCodec codec)
+{
+    codec = effectiveCodec(codec);
+    std::string target = path + (codec == CompressionCodec::GZIP ? ".gz" : ".lz4");
+    std::string temporary = target + ".tmp";
+
+    bool ok = false;
+#ifdef ULOGGER_HAVE_ZLIB
+    if (codec == CompressionCodec::GZIP) {
+        ok = gzip::compressFile(path, temporary);
+    }
+#endif
+    if (codec == CompressionCodec::LZ4) {
+        ok = lz4::compressFile(path, temporary);
+    }
+
+    if (!ok || std::rename(temporary.c_str(), target.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return "";
+    }
+    return target;
+}
+
+#endif // ULOGGER_CODEC_H
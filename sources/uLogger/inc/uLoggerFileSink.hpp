@@ -0,0 +1,1582 @@
+#ifndef ULOGGER_FILE_SINK_H
+#define ULOGGER_FILE_SINK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "uLoggerCodec.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+#ifdef ULOGGER_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+/**
+ * @brief Selects the backend used to write log files.
+ */
+enum class FileIoMode {
+    AUTO,             /**< O_APPEND descriptor writes (FD), which other appenders and copytruncate leave intact. */
+    STREAM,           /**< Portable std::ofstream backend. */
+    FD,               /**< Buffered POSIX file descriptor backend. */
+    IO_URING,         /**< Asynchronous io_uring backend writing at its own offsets; sole writer only (falls back to FD). */
+    DIRECT,           /**< O_DIRECT aligned blocks, bypassing the page cache (falls back to FD). */
+    SHARED            /**< O_APPEND writes of whole records only, for a file shared by several processes. */
+};
+
+/**
+ * @brief Tuning options shared by the file sinks.
+ */
+struct FileSinkOptions {
+    FileIoMode ioMode = FileIoMode::AUTO;
+    size_t blockSize = 64 * 1024;     /**< Bytes buffered before a write is issued. */
+    size_t blockCount = 4;            /**< Write blocks kept in flight (io_uring only). */
+    bool blockCompression = false;    /**< Write LZ4 frames of up to 64 KiB instead of plain text. */
+    size_t ringSize = 0;              /**< Write a preallocated ring of this many bytes; 0 for a growing file. */
+    size_t preallocateSize = 8 << 20; /**< Disk space reserved ahead of the writes; 0 disables. */
+    bool dropCache = false;           /**< Evict written pages from the page cache once they are on disk. */
+    bool binaryRecords = false;       /**< Records are binary log entries, not text lines; a ring keeps this in its header. */
+    std::function<void(std::function<void()>)> background;   /**< Runs blocking housekeeping off the writing thread; null runs it in place. */
+};
+
+/**
+ * @brief Byte-oriented log file backend.
+ *
+ * Sinks receive whole formatted records and are always called with
+ * LogBuffer::logMutex held, so they need no locking of their own.
+ */
+struct FileSink
+{
+    virtual ~FileSink() = default;
+
+    /**
+     * @brief Returns true while the underlying file is usable.
+     */
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Queues one or more whole records for writing.
+     */
+    virtual void write(const char* data, size_t size) = 0;
+
+    /**
+     * @brief Hands buffered data to the kernel, without waiting where the backend allows it.
+     */
+    virtual void flush() = 0;
+
+    /**
+     * @brief Makes everything written so far durable on disk.
+     */
+    virtual void sync() = 0;
+
+    /**
+     * @brief Moves everything written into the page cache and returns a descriptor
+     * whose fdatasync makes it durable, or -1 if only sync() can do that.
+     *
+     * Lets a caller pay for the disk flush without holding the logger lock.
+     */
+    virtual int syncHandle()
+    {
+        return -1;
+    }
+
+    /**
+     * @brief Writes out pending data and closes the file.
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Writes buffered records, then @p marker, straight to the file from a crash handler.
+     *
+     * Only async-signal-safe calls and no locks: other threads may still be
+     * inside write(). Backends that cannot do this leave their data alone.
+     */
+    virtual void drainOnCrash(const char* marker, size_t size)
+    {
+        (void)marker;
+        (void)size;
+    }
+
+    /**
+     * @brief Lets go of the file in a forked child, which then leaks the sink instead of destroying it.
+     *
+     * Closes this process's descriptors without writing, trimming or
+     * syncing anything: the parent owns the file and any I/O in flight.
+     */
+    virtual void abandonAfterFork()
+    {
+    }
+};
+
+/**
+ * @brief Portable backend built on std::ofstream.
+ */
+struct StreamFileSink : FileSink
+{
+    std::ofstream stream;
+
+    explicit StreamFileSink(const std::string& path)
+    {
+        stream.open(path, std::ios::out | std::ios::app);
+    }
+
+    ~StreamFileSink() override
+    {
+        close();
+    }
+
+    bool isOpen() const override
+    {
+        return stream.is_open();
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        stream.write(data, static_cast<std::streamsize>(size));
+    }
+
+    void flush() override
+    {
+        stream.flush();
+    }
+
+    void sync() override
+    {
+        stream.flush();
+    }
+
+    void close() override
+    {
+        if (stream.is_open()) {
+            stream.flush();
+            stream.close();
+        }
+    }
+};
+
+/**
+ * @brief Header at the start of a ring file, in host byte order.
+ *
+ * Records are stored as a 32-bit length and the record bytes, wrapping at
+ * the end of the data area. head and tail are logical offsets that only
+ * grow; the live records are the ones in [tail, head).
+ */
+struct RingHeader {
+    char magic[8];        /**< "ULOGRING" */
+    uint32_t version;
+    uint32_t flags;       /**< RING_BINARY if the records are binary log entries, fixed at creation. */
+    uint64_t capacity;    /**< Size of the data area. */
+    uint64_t head;        /**< Where the next record goes. */
+    uint64_t tail;        /**< Start of the oldest record still in the ring. */
+};
+
+constexpr char RING_MAGIC[8] = { 'U', 'L', 'O', 'G', 'R', 'I', 'N', 'G' };
+constexpr uint32_t RING_VERSION = 1;
+constexpr uint32_t RING_BINARY = 0x01;
+constexpr size_t RING_HEADER_SIZE = 4096;   // keeps the data area page aligned
+constexpr size_t RING_RECORD_PREFIX = sizeof(uint32_t);
+
+/**
+ * @brief Checks that a ring header is consistent with a data area of @p capacity bytes.
+ */
+inline bool isValidRing(const RingHeader& header, uint64_t capacity)
+{
+    return std::memcmp(header.magic, RING_MAGIC, sizeof(RING_MAGIC)) == 0 &&
+           header.version == RING_VERSION && header.capacity == capacity &&
+           header.tail <= header.head && header.head - header.tail <= capacity;
+}
+
+/**
+ * @brief Passes the records of a ring file to @p output, oldest first.
+ * @return False if the file is not a ring or a record is damaged.
+ */
+inline bool readRingFile(std::FILE* in, const std::function<void(const char*, size_t)>& output, RingHeader& header)
+{
+    if (std::fread(&header, sizeof(header), 1, in) != 1 || !isValidRing(header, header.capacity) ||
+        header.capacity <= RING_RECORD_PREFIX) {
+        return false;
+    }
+
+    auto readAt = [&](uint64_t position, char* data, size_t size) {
+        size_t offset = static_cast<size_t>(position % header.capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(header.capacity) - offset);
+        if (std::fseek(in, static_cast<long>(RING_HEADER_SIZE + offset), SEEK_SET) != 0 ||
+            std::fread(data, 1, first, in) != first) {
+            return false;
+        }
+        if (first < size) {
+            return std::fseek(in, static_cast<long>(RING_HEADER_SIZE), SEEK_SET) == 0 &&
+                   std::fread(data + first, 1, size - first, in) == size - first;
+        }
+        return true;
+    };
+
+    std::vector<char> record;
+    uint64_t position = header.tail;
+    while (position < header.head) {
+        uint32_t length;
+        if (header.head - position < RING_RECORD_PREFIX ||
+            !readAt(position, reinterpret_cast<char*>(&length), sizeof(length)) ||
+            length > header.head - position - RING_RECORD_PREFIX) {
+            return false;
+        }
+        record.resize(length);
+        if (!readAt(position + RING_RECORD_PREFIX, record.data(), length)) {
+            return false;
+        }
+        output(record.data(), length);
+        position += RING_RECORD_PREFIX + length;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+
+/**
+ * @brief Writes a whole range to a descriptor, retrying on EINTR and short writes.
+ * @return False if the kernel reported an error.
+ */
+inline bool writeFully(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Reserves disk space ahead of a sink's writes and evicts written pages.
+ *
+ * Space is reserved with fallocate(FALLOC_FL_KEEP_SIZE) in large chunks, so
+ * the file keeps its real length while its extent grows rarely; the unused
+ * tail is released on close. With dropCache, writeback of each window is
+ * started once it is complete. The window before it is then waited for
+ * and evicted with POSIX_FADV_DONTNEED in the background, since the wait
+ * would stall the writer; sync() evicts everything written.
+ */
+struct FileExtent
+{
+    static constexpr uint64_t CACHE_WINDOW = 8 << 20;
+
+    int fd = -1;
+    uint64_t end = 0;          // bytes handed to the kernel
+    uint64_t allocated = 0;    // space reserved up to here
+    uint64_t writtenBack = 0;  // writeback started up to here
+    uint64_t dropped = 0;      // evicted up to here
+    uint64_t chunk = 0;
+    bool dropCache = false;
+    std::function<void(std::function<void()>)> background;
+
+    void attach(int descriptor, uint64_t size, const FileSinkOptions& options)
+    {
+        fd = descriptor;
+        end = allocated = size;
+        writtenBack = dropped = pageFloor(size);
+        chunk = options.preallocateSize;
+        dropCache = options.dropCache;
+        background = options.background;
+    }
+
+    /**
+     * @brief Records that the file now extends to @p position.
+     */
+    void advance(uint64_t position)
+    {
+        end = std::max(end, position);
+#ifdef __linux__
+        if (chunk > 0 && end > allocated) {
+            uint64_t target = end + chunk;
+            if (::fallocate(fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated),
+                            static_cast<off_t>(target - allocated)) == 0) {
+                allocated = target;
+            } else {
+                chunk = 0;   // file system without fallocate
+            }
+        }
+        if (dropCache && end - writtenBack >= CACHE_WINDOW) {
+            // The previous window has had a full window's time to reach the disk
+            if (writtenBack > dropped) {
+                evictWrittenBack(dropped, writtenBack);
+                dropped = writtenBack;
+            }
+            uint64_t until = pageFloor(end);
+            ::sync_file_range(fd, static_cast<off_t>(writtenBack), static_cast<off_t>(until - writtenBack),
+                              SYNC_FILE_RANGE_WRITE);
+            writtenBack = until;
+        }
+#endif
+    }
+
+    /**
+     * @brief Called after fdatasync: everything written is on disk and can be evicted.
+     */
+    void synced()
+    {
+        if (dropCache) {
+            evict(pageFloor(end));
+            writtenBack = std::max(writtenBack, dropped);
+        }
+    }
+
+    /**
+     * @brief Gives back the space reserved past the end of the file.
+     *
+     * Trims only a file that still ends where this sink left it. When
+     * another writer appended, or a copytruncate emptied it, the file's
+     * length is left alone and just the reservation past it is freed.
+     */
+    void release()
+    {
+#ifdef __linux__
+        struct stat st;
+        if (fd >= 0 && allocated > end && ::fstat(fd, &st) == 0) {
+            uint64_t size = static_cast<uint64_t>(st.st_size);
+            if (size == end) {
+                int result = ::ftruncate(fd, static_cast<off_t>(end));
+                (void)result;
+            } else if (allocated > size) {
+                int result = ::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(size),
+                                         static_cast<off_t>(allocated - size));
+                (void)result;
+            }
+        }
+#endif
+        allocated = end;
+    }
+
+private:
+    static uint64_t pageFloor(uint64_t offset)
+    {
+        return offset & ~static_cast<uint64_t>(4095);
+    }
+
+#ifdef __linux__
+    /**
+     * @brief Waits for the writeback of [from, until) and evicts it, in the background if possible.
+     */
+    void evictWrittenBack(uint64_t from, uint64_t until)
+    {
+        // A descriptor of its own keeps the task valid after the sink closes
+        int copy = background ? ::fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1;
+        if (copy < 0) {
+            waitAndEvict(fd, from, until);
+            return;
+        }
+        background([copy, from, until] {
+            waitAndEvict(copy, from, until);
+            ::close(copy);
+        });
+    }
+
+    static void waitAndEvict(int descriptor, uint64_t from, uint64_t until)
+    {
+        ::sync_file_range(descriptor, static_cast<off_t>(from), static_cast<off_t>(until - from),
+                          SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        ::posix_fadvise(descriptor, static_cast<off_t>(from), static_cast<off_t>(until - from), POSIX_FADV_DONTNEED);
+    }
+#endif
+
+    void evict(uint64_t until)
+    {
+        if (until > dropped) {
+            ::posix_fadvise(fd, static_cast<off_t>(dropped), static_cast<off_t>(until - dropped), POSIX_FADV_DONTNEED);
+            dropped = until;
+        }
+    }
+};
+
+/**
+ * @brief Buffered backend writing whole blocks with write(2).
+ *
+ * The file is opened with O_APPEND and a block only ever holds whole
+ * records, so every write(2) appends a batch of complete records. Local
+ * file systems serialize O_APPEND writes, which lets several processes
+ * share one file without interleaved lines (FileIoMode::SHARED).
+ */
+struct FdFileSink : FileSink
+{
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t pending = 0;
+    FileExtent extent;
+
+    explicit FdFileSink(const std::string& path, const FileSinkOptions& options = {})
+        : buffer(options.blockSize)
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        struct stat st;
+        if (fd >= 0 && ::fstat(fd, &st) == 0) {
+            extent.attach(fd, static_cast<uint64_t>(st.st_size), options);
+        }
+    }
+
+    ~FdFileSink() override
+    {
+        close();
+    }
+
+    bool isOpen() const override
+    {
+        return fd >= 0;
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        if (fd < 0) return;
+
+        if (pending + size > buffer.size()) {
+            flush();
+        }
+        if (size >= buffer.size()) {
+            writeFully(fd, data, size);
+            extent.advance(extent.end + size);
+            return;
+        }
+        std::memcpy(buffer.data() + pending, data, size);
+        pending += size;
+    }
+
+    void flush() override
+    {
+        if (fd >= 0 && pending > 0) {
+            writeFully(fd, buffer.data(), pending);
+            extent.advance(extent.end + pending);
+        }
+        pending = 0;
+    }
+
+    void sync() override
+    {
+        flush();
+        if (fd >= 0 && ::fdatasync(fd) == 0) {
+            extent.synced();
+        }
+    }
+
+    int syncHandle() override
+    {
+        flush();
+        return fd;
+    }
+
+    void close() override
+    {
+        if (fd >= 0) {
+            flush();
+            extent.release();
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    void drainOnCrash(const char* marker, size_t size) override
+    {
+        if (fd < 0) return;
+        if (pending > 0) {
+            writeFully(fd, buffer.data(), pending);
+            pending = 0;
+        }
+        writeFully(fd, marker, size);
+    }
+
+    void abandonAfterFork() override
+    {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        pending = 0;
+    }
+};
+
+#ifdef O_DIRECT
+
+/**
+ * @brief Direct I/O backend that bypasses the page cache.
+ *
+ * Records are collected in one of two aligned blocks; a full block is
+ * handed to a writer thread while the other one keeps filling, so the
+ * caller only waits when the disk is a whole block behind. Flushing
+ * writes the partial block padded to the device alignment and trims the
+ * file back to its logical size; the same block is rewritten once it
+ * fills up.
+ */
+struct DirectFileSink : FileSink
+{
+    int fd = -1;
+    size_t blockSize = 0;
+    size_t alignment = 4096;
+
+    char* blocks[2] {};
+    size_t active = 0;
+    size_t used = 0;
+    uint64_t blockOffset = 0;   // file offset of the active block
+
+    // Writer thread hand-off
+    std::thread writer;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const char* jobData = nullptr;
+    size_t jobLength = 0;
+    uint64_t jobOffset = 0;
+    uint64_t jobTruncate = 0;
+    std::atomic<bool> jobPending {false};   // atomic for the crash handler, which cannot take jobMutex
+    std::atomic<bool> crashed {false};      // the writer must not trim what drainOnCrash() wrote
+    bool stopping = false;
+
+    static constexpr int CRASH_JOB_WAIT_MS = 1000;
+
+    explicit DirectFileSink(const std::string& path, const FileSinkOptions& options = {})
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_DIRECT | O_CLOEXEC, 0644);
+        if (fd < 0) return;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        alignment = std::max<size_t>(alignment, static_cast<size_t>(st.st_blksize));
+        blockSize = (options.blockSize + alignment - 1) / alignment * alignment;
+
+        for (auto& block : blocks) {
+            void* mem = nullptr;
+            if (::posix_memalign(&mem, alignment, blockSize) != 0) {
+                releaseBlocks();
+                ::close(fd);
+                fd = -1;
+                return;
+            }
+            block = static_cast<char*>(mem);
+        }
+
+        // Appending to an unaligned file: reload its tail so the block can be rewritten in place
+        uint64_t size = static_cast<uint64_t>(st.st_size);
+        blockOffset = size / alignment * alignment;
+        used = static_cast<size_t>(size - blockOffset);
+        if (used > 0 && !loadTail(path)) {
+            releaseBlocks();
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+
+        writer = std::thread([this] { writerLoop(); });
+    }
+
+    ~DirectFileSink() override
+    {
+        close();
+    }
+
+    bool isOpen() const override
+    {
+        return fd >= 0;
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        if (fd < 0) return;
+
+        while (size > 0) {
+            size_t toCopy = std::min(size, blockSize - used);
+            std::memcpy(blocks[active] + used, data, toCopy);
+            used += toCopy;
+            data += toCopy;
+            size -= toCopy;
+
+            if (used == blockSize) {
+                post(blocks[active], blockSize, blockOffset, 0);
+                active ^= 1;
+                blockOffset += blockSize;
+                used = 0;
+            }
+        }
+    }
+
+    void flush() override
+    {
+        if (fd < 0 || used == 0) return;
+
+        // The active block stays in place; a padded copy goes out through the idle one
+        waitIdle();
+        char* spare = blocks[active ^ 1];
+        size_t padded = (used + alignment - 1) / alignment * alignment;
+        std::memcpy(spare, blocks[active], used);
+        std::memset(spare + used, 0, padded - used);
+        post(spare, padded, blockOffset, blockOffset + used);
+    }
+
+    void sync() override
+    {
+        if (fd < 0) return;
+        flush();
+        waitIdle();
+        ::fdatasync(fd);
+    }
+
+    void close() override
+    {
+        if (fd < 0) return;
+
+        flush();
+        waitIdle();
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping = true;
+        }
+        jobReady.notify_one();
+        writer.join();
+
+        ::close(fd);
+        fd = -1;
+        releaseBlocks();
+    }
+
+    void drainOnCrash(const char* marker, size_t size) override
+    {
+        if (fd < 0) return;
+        // A job still in flight may be a padded copy of this very block, followed by a trim to its
+        // older length; let it finish first. The wait is bounded: the crash may be on the writer thread.
+        for (int waited = 0; jobPending.load() && waited < CRASH_JOB_WAIT_MS; ++waited) {
+            struct timespec pause {0, 1000000};
+            ::nanosleep(&pause, nullptr);
+        }
+        crashed.store(true);
+        // The writer thread may still own the other block; this one is ours, and so is the file past it
+        char* block = blocks[active];
+        while (size > 0 && used < blockSize) {
+            size_t toCopy = std::min(size, blockSize - used);
+            std::memcpy(block + used, marker, toCopy);
+            used += toCopy;
+            marker += toCopy;
+            size -= toCopy;
+        }
+        if (used == 0) return;
+        size_t padded = (used + alignment - 1) / alignment * alignment;
+        std::memset(block + used, 0, padded - used);
+        size_t done = 0;
+        while (done < padded) {
+            ssize_t written = ::pwrite(fd, block + done, padded - done, static_cast<off_t>(blockOffset + done));
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            done += static_cast<size_t>(written);
+        }
+        while (::ftruncate(fd, static_cast<off_t>(blockOffset + used)) < 0 && errno == EINTR) {
+        }
+    }
+
+    void abandonAfterFork() override
+    {
+        // The writer thread was not copied; the parent's goes on with its job
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+private:
+    bool loadTail(const std::string& path)
+    {
+        // O_DIRECT reads need the same alignment, so use a buffered descriptor for the tail
+        int in = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) return false;
+        ssize_t got = ::pread(in, blocks[active], used, static_cast<off_t>(blockOffset));
+        ::close(in);
+        return got == static_cast<ssize_t>(used);
+    }
+
+    void releaseBlocks()
+    {
+        for (auto& block : blocks) {
+            std::free(block);
+            block = nullptr;
+        }
+    }
+
+    void waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobDone.wait(lock, [this] { return !jobPending; });
+    }
+
+    void post(const char* data, size_t length, uint64_t offset, uint64_t truncateTo)
+    {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobDone.wait(lock, [this] { return !jobPending; });
+            jobData = data;
+            jobLength = length;
+            jobOffset = offset;
+            jobTruncate = truncateTo;
+            jobPending = true;
+        }
+        jobReady.notify_one();
+    }
+
+    void writerLoop()
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        for (;;) {
+            jobReady.wait(lock, [this] { return jobPending || stopping; });
+            if (!jobPending) return;
+
+            lock.unlock();
+            size_t done = 0;
+            while (done < jobLength) {
+                ssize_t written = ::pwrite(fd, jobData + done, jobLength - done,
+                                           static_cast<off_t>(jobOffset + done));
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                done += static_cast<size_t>(written);
+            }
+            if (jobTruncate > 0 && !crashed.load()) {
+                // Drop the zero padding of a partial block
+                while (::ftruncate(fd, static_cast<off_t>(jobTruncate)) < 0 && errno == EINTR) {
+                }
+            }
+            lock.lock();
+
+            jobPending = false;
+            jobDone.notify_all();
+        }
+    }
+};
+
+#endif // O_DIRECT
+
+/**
+ * @brief Fixed-size ring file: preallocated once and memory-mapped.
+ *
+ * Each write() is stored as one record; the oldest records are dropped to
+ * make room. The file never grows, so after creation there is no file-system
+ * metadata traffic, and records reach the page cache without a system call.
+ * An existing ring of the same size and record format is resumed, anything
+ * else is replaced.
+ */
+struct RingFileSink : FileSink
+{
+    int fd = -1;
+    char* map = nullptr;
+    size_t mapSize = 0;
+    RingHeader* header = nullptr;
+    char* ring = nullptr;
+    uint64_t capacity = 0;
+
+    RingFileSink(const std::string& path, size_t ringSize, bool binaryRecords)
+        : mapSize(RING_HEADER_SIZE + ringSize), capacity(ringSize)
+    {
+        if (ringSize <= RING_RECORD_PREFIX) return;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return;
+
+        RingHeader existing {};
+        struct stat st;
+        bool resume = ::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == mapSize &&
+                      ::pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+                      isValidRing(existing, capacity) && ((existing.flags & RING_BINARY) != 0) == binaryRecords;
+        if (!resume && (::ftruncate(fd, 0) != 0 || ::posix_fallocate(fd, 0, static_cast<off_t>(mapSize)) != 0)) {
+            close();
+            return;
+        }
+
+        void* mapped = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close();
+            return;
+        }
+        map = static_cast<char*>(mapped);
+        header = reinterpret_cast<RingHeader*>(map);
+        ring = map + RING_HEADER_SIZE;
+
+        if (!resume) {
+            std::memset(header, 0, sizeof(RingHeader));
+            std::memcpy(header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+            header->version = RING_VERSION;
+            header->capacity = capacity;
+            header->flags = binaryRecords ? RING_BINARY : 0;
+        }
+    }
+
+    ~RingFileSink() override
+    {
+        close();
+    }
+
+    bool isOpen() const override
+    {
+        return map != nullptr;
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        if (!map || size == 0) return;
+        // A record larger than the whole ring keeps its beginning
+        size = std::min<size_t>(size, static_cast<size_t>(capacity) - RING_RECORD_PREFIX);
+
+        uint64_t needed = RING_RECORD_PREFIX + size;
+        uint64_t head = header->head;
+        uint64_t tail = header->tail;
+        while (head + needed - tail > capacity) {
+            uint32_t length;
+            copyOut(tail, reinterpret_cast<char*>(&length), sizeof(length));
+            tail += RING_RECORD_PREFIX + length;
+        }
+        // Publish the new tail before overwriting, so a crash never leaves a torn record inside [tail, head)
+        header->tail = tail;
+
+        uint32_t length = static_cast<uint32_t>(size);
+        copyIn(head, reinterpret_cast<const char*>(&length), sizeof(length));
+        copyIn(head + RING_RECORD_PREFIX, data, size);
+        header->head = head + needed;
+    }
+
+    void flush() override
+    {
+        // Stores to the mapping are already in the page cache
+    }
+
+    void drainOnCrash(const char* marker, size_t size) override
+    {
+        // Records are already in the page cache, and write() is only stores to the mapping
+        write(marker, size);
+    }
+
+    void abandonAfterFork() override
+    {
+        // A ring has a single writer
+        if (map) {
+            ::munmap(map, mapSize);
+            map = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    void sync() override
+    {
+        if (map) {
+            ::msync(map, mapSize, MS_SYNC);
+        }
+    }
+
+    int syncHandle() override
+    {
+        // fdatasync also writes back pages dirtied through a shared mapping
+        return map ? fd : -1;
+    }
+
+    void close() override
+    {
+        if (map) {
+            ::munmap(map, mapSize);
+            map = nullptr;
+            header = nullptr;
+            ring = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+private:
+    void copyIn(uint64_t position, const char* data, size_t size)
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(ring + offset, data, first);
+        std::memcpy(ring, data + first, size - first);
+    }
+
+    void copyOut(uint64_t position, char* data, size_t size) const
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(data, ring + offset, first);
+        std::memcpy(data + first, ring, size - first);
+    }
+};
+
+#endif // _WIN32
+
+#ifdef ULOGGER_HAVE_IO_URING
+
+/**
+ * @brief Asynchronous backend submitting fixed-size blocks through io_uring.
+ *
+ * Records are copied into registered buffers; a full (or flushed) block is
+ * submitted as a write at an explicit file offset and the caller returns
+ * immediately. Up to FileSinkOptions::blockCount blocks are in flight, and
+ * the caller only waits when every block is still owned by the kernel.
+ * sync() links a data-only fsync behind the last write.
+ */
+struct UringFileSink : FileSink
+{
+    static constexpr uint64_t SYNC_TAG = ~0ULL;
+
+    struct Block {
+        char* data = nullptr;
+        size_t used = 0;
+        uint64_t offset = 0;
+        bool inFlight = false;
+    };
+
+    int fd = -1;
+    int ringFd = -1;
+    bool fixedBuffers = false;
+
+    std::vector<Block> blocks;
+    size_t blockSize = 0;
+    size_t current = 0;
+    size_t inFlight = 0;
+    size_t syncsInFlight = 0;
+    uint64_t fileOffset = 0;
+    FileExtent extent;
+
+    // Mapped ring state
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned toSubmit = 0;
+
+    explicit UringFileSink(const std::string& path, const FileSinkOptions& options = {})
+        : blockSize(options.blockSize)
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0) {
+            fileOffset = static_cast<uint64_t>(st.st_size);
+        }
+        extent.attach(fd, fileOffset, options);
+
+        if (!setupRing(static_cast<unsigned>(options.blockCount * 2 + 2)) ||
+            !setupBlocks(options.blockCount < 2 ? 2 : options.blockCount)) {
+            teardown();
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    ~UringFileSink() override
+    {
+        close();
+    }
+
+    bool isOpen() const override
+    {
+        return fd >= 0;
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        if (fd < 0) return;
+
+        while (size > 0) {
+            Block& block = blocks[current];
+            size_t toCopy = std::min(size, blockSize - block.used);
+            std::memcpy(block.data + block.used, data, toCopy);
+            block.used += toCopy;
+            data += toCopy;
+            size -= toCopy;
+
+            if (block.used == blockSize) {
+                submitCurrent(false);
+            }
+        }
+    }
+
+    void flush() override
+    {
+        if (fd < 0) return;
+        if (blocks[current].used > 0) {
+            submitCurrent(false);
+        }
+        reap(false);
+    }
+
+    void sync() override
+    {
+        if (fd < 0) return;
+        if (blocks[current].used > 0) {
+            submitCurrent(true);
+        } else {
+            pushSync();
+            enter(0);
+        }
+        while (syncsInFlight > 0) {
+            reap(true);
+        }
+        extent.synced();
+    }
+
+    int syncHandle() override
+    {
+        if (fd < 0) return -1;
+        if (blocks[current].used > 0) {
+            submitCurrent(false);
+        }
+        while (inFlight > 0) {
+            reap(true);
+        }
+        return fd;
+    }
+
+    void close() override
+    {
+        if (fd < 0) return;
+        if (blocks[current].used > 0) {
+            submitCurrent(false);
+        }
+        while (inFlight > 0 || syncsInFlight > 0) {
+            reap(true);
+        }
+        extent.release();
+        teardown();
+        ::close(fd);
+        fd = -1;
+    }
+
+    void drainOnCrash(const char* marker, size_t size) override
+    {
+        if (fd < 0) return;
+        // Submitted blocks may not have reached the file; writing them again at their offsets is harmless
+        for (const Block& block : blocks) {
+            if (block.inFlight) {
+                writeAt(block.data, block.used, block.offset);
+            }
+        }
+        Block& block = blocks[current];
+        if (!block.inFlight) {
+            writeAt(block.data, block.used, fileOffset);
+            fileOffset += block.used;
+            block.used = 0;
+        }
+        writeAt(marker, size, fileOffset);
+        fileOffset += size;
+    }
+
+    void abandonAfterFork() override
+    {
+        // The kernel completes the parent's submissions; unmapping and closing here only affects this process
+        if (fd < 0) return;
+        teardown();
+        ::close(fd);
+        fd = -1;
+    }
+
+private:
+    void writeAt(const char* data, size_t size, uint64_t offset)
+    {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t written = ::pwrite(fd, data + done, size - done, static_cast<off_t>(offset + done));
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            done += static_cast<size_t>(written);
+        }
+    }
+
+    static int ringSetup(unsigned entries, io_uring_params* params)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    static int ringEnter(int ring, unsigned submit, unsigned minComplete, unsigned flags)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, ring, submit, minComplete, flags, nullptr, 0));
+    }
+
+    static int ringRegister(int ring, unsigned opcode, const void* arg, unsigned count)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_register, ring, opcode, arg, count));
+    }
+
+    static unsigned loadAcquire(unsigned* p)
+    {
+        return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+    }
+
+    static void storeRelease(unsigned* p, unsigned value)
+    {
+        std::atomic_ref<unsigned>(*p).store(value, std::memory_order_release);
+    }
+
+    bool setupRing(unsigned entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = ringSetup(entries, &params);
+        if (ringFd < 0) return false;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        }
+
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            sqRing = nullptr;
+            return false;
+        }
+        if (singleMmap) {
+            cqRing = sqRing;
+        } else {
+            cqRing = ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                cqRing = nullptr;
+                return false;
+            }
+        }
+
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMap = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ringFd, IORING_OFF_SQES);
+        if (sqeMap == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    bool setupBlocks(size_t count)
+    {
+        blocks.resize(count);
+        std::vector<iovec> iovs(count);
+        for (size_t i = 0; i < count; ++i) {
+            void* mem = nullptr;
+            if (::posix_memalign(&mem, 4096, blockSize) != 0) return false;
+            blocks[i].data = static_cast<char*>(mem);
+            iovs[i].iov_base = mem;
+            iovs[i].iov_len = blockSize;
+        }
+        // Registered buffers spare the kernel a page pin per write; plain writes still work without them.
+        fixedBuffers = ringRegister(ringFd, IORING_REGISTER_BUFFERS, iovs.data(),
+                                    static_cast<unsigned>(count)) == 0;
+        return true;
+    }
+
+    void teardown()
+    {
+        if (sqes) ::munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing) ::munmap(cqRing, cqRingSize);
+        if (sqRing) ::munmap(sqRing, sqRingSize);
+        sqes = nullptr;
+        sqRing = cqRing = nullptr;
+        if (ringFd >= 0) ::close(ringFd);
+        ringFd = -1;
+        for (auto& block : blocks) {
+            std::free(block.data);
+            block.data = nullptr;
+        }
+    }
+
+    io_uring_sqe* nextSqe()
+    {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        storeRelease(sqTail, tail + 1);
+        ++toSubmit;
+        return sqe;
+    }
+
+    void pushWrite(size_t index, bool linkSync)
+    {
+        Block& block = blocks[index];
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(block.data);
+        sqe->len = static_cast<uint32_t>(block.used);
+        sqe->off = block.offset;
+        sqe->buf_index = fixedBuffers ? static_cast<uint16_t>(index) : 0;
+        sqe->user_data = index;
+        if (linkSync) {
+            sqe->flags |= IOSQE_IO_LINK;
+        }
+    }
+
+    void pushSync()
+    {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = fd;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->flags |= IOSQE_IO_DRAIN;   // also covers blocks submitted earlier
+        sqe->user_data = SYNC_TAG;
+        ++syncsInFlight;
+    }
+
+    void enter(unsigned minComplete)
+    {
+        unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        while (ringEnter(ringFd, toSubmit, minComplete, flags) < 0 && errno == EINTR) {
+        }
+        toSubmit = 0;
+    }
+
+    void submitCurrent(bool linkSync)
+    {
+        Block& block = blocks[current];
+        block.offset = fileOffset;
+        block.inFlight = true;
+        fileOffset += block.used;
+        ++inFlight;
+        extent.advance(fileOffset);
+
+        pushWrite(current, linkSync);
+        if (linkSync) {
+            pushSync();
+        }
+        enter(0);
+
+        // Move on to the next block, waiting only if the kernel still owns it
+        current = (current + 1) % blocks.size();
+        while (blocks[current].inFlight) {
+            reap(true);
+        }
+    }
+
+    void completeWrite(size_t index, int result)
+    {
+        Block& block = blocks[index];
+        size_t done = result > 0 ? static_cast<size_t>(result) : 0;
+        // Short or failed writes are finished synchronously so the file has no holes
+        while (done < block.used) {
+            ssize_t written = ::pwrite(fd, block.data + done, block.used - done,
+                                       static_cast<off_t>(block.offset + done));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            done += static_cast<size_t>(written);
+        }
+        block.used = 0;
+        block.inFlight = false;
+        --inFlight;
+    }
+
+    void reap(bool wait)
+    {
+        if (wait && loadAcquire(cqTail) == *cqHead) {
+            enter(1);
+        }
+
+        unsigned head = *cqHead;
+        unsigned tail = loadAcquire(cqTail);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            if (cqe.user_data == SYNC_TAG) {
+                --syncsInFlight;
+            } else {
+                completeWrite(static_cast<size_t>(cqe.user_data), cqe.res);
+            }
+            ++head;
+        }
+        storeRelease(cqHead, head);
+    }
+};
+
+#endif // ULOGGER_HAVE_IO_URING
+
+/**
+ * @brief Streaming sink that compresses the log in independent LZ4 frames.
+ *
+ * Records fill a block of up to 64 KiB; full blocks (and partial ones on
+ * flush) are compressed on a background thread and written to the inner
+ * sink as complete frames with block checksums. A file cut short by a
+ * crash therefore decodes up to its last whole frame, with lz4 -d or with
+ * lz4::decompressFrames().
+ */
+struct CompressedFileSink : FileSink
+{
+    static constexpr size_t MAX_QUEUED_BLOCKS = 4;
+
+    enum class JobType { WRITE, FLUSH, SYNC, STOP };
+
+    struct Job {
+        JobType type = JobType::WRITE;
+        std::vector<char> data;
+    };
+
+    std::unique_ptr<FileSink> inner;
+    size_t blockSize = lz4::MAX_BLOCK_SIZE;
+    std::vector<char> filling;
+
+    std::thread compressor;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    std::deque<Job> jobs;
+    std::vector<std::vector<char>> freeBlocks;
+    uint64_t jobsPosted = 0;
+    uint64_t jobsCompleted = 0;
+
+    CompressedFileSink(std::unique_ptr<FileSink> target, const FileSinkOptions& options = {})
+        : inner(std::move(target)),
+          blockSize(std::min(options.blockSize, lz4::MAX_BLOCK_SIZE))
+    {
+        filling.reserve(blockSize);
+        if (inner && inner->isOpen()) {
+            compressor = std::thread([this] { run(); });
+        }
+    }
+
+    ~CompressedFileSink() override
+    {
+        close();
+    }
+
+    bool isOpen() const override
+    {
+        return compressor.joinable();
+    }
+
+    void write(const char* data, size_t size) override
+    {
+        if (!isOpen()) return;
+
+        while (size > 0) {
+            size_t toCopy = std::min(size, blockSize - filling.size());
+            filling.insert(filling.end(), data, data + toCopy);
+            data += toCopy;
+            size -= toCopy;
+
+            if (filling.size() == blockSize) {
+                postBlock();
+            }
+        }
+    }
+
+    void flush() override
+    {
+        if (!isOpen()) return;
+        postBlock();
+        post(JobType::FLUSH, {});
+    }
+
+    void sync() override
+    {
+        if (!isOpen()) return;
+        postBlock();
+        uint64_t ticket = post(JobType::SYNC, {});
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobDone.wait(lock, [this, ticket] { return jobsCompleted >= ticket; });
+    }
+
+    void close() override
+    {
+        if (!isOpen()) return;
+        postBlock();
+        post(JobType::STOP, {});
+        compressor.join();
+        inner->close();
+    }
+
+    void abandonAfterFork() override
+    {
+        // The compressor thread was not copied; forget its handle so isOpen() turns false
+        new (&compressor) std::thread();
+        inner->abandonAfterFork();
+    }
+
+private:
+    void postBlock()
+    {
+        if (filling.empty()) return;
+
+        std::vector<char> next;
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (!freeBlocks.empty()) {
+                next = std::move(freeBlocks.back());
+                freeBlocks.pop_back();
+            }
+        }
+        next.clear();
+        next.reserve(blockSize);
+        std::swap(next, filling);
+        post(JobType::WRITE, std::move(next));
+    }
+
+    uint64_t post(JobType type, std::vector<char> data)
+    {
+        uint64_t ticket;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            // Back-pressure: never hold more than a few uncompressed blocks
+            jobDone.wait(lock, [this] { return jobs.size() < MAX_QUEUED_BLOCKS; });
+            jobs.push_back({type, std::move(data)});
+            ticket = ++jobsPosted;
+        }
+        jobReady.notify_one();
+        return ticket;
+    }
+
+    void run()
+    {
+        std::vector<char> frame;
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobReady.wait(lock, [this] { return !jobs.empty(); });
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            switch (job.type) {
+                case JobType::WRITE:
+                    frame.clear();
+                    lz4::appendBlockFrame(frame, job.data.data(), job.data.size());
+                    inner->write(frame.data(), frame.size());
+                    break;
+                case JobType::FLUSH:
+                    inner->flush();
+                    break;
+                case JobType::SYNC:
+                    inner->sync();
+                    break;
+                case JobType::STOP:
+                    break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                if (job.type == JobType::WRITE) {
+                    freeBlocks.push_back(std::move(job.data));
+                }
+                ++jobsCompleted;
+            }
+            jobDone.notify_all();
+
+            if (job.type == JobType::STOP) return;
+        }
+    }
+};
+
+/**
+ * @brief Opens a log file with the backend selected in the options.
+ *
+ * Backends that cannot be set up on this system fall back to the plain
+ * descriptor sink (or std::ofstream where POSIX I/O is unavailable).
+ */
+inline std::unique_ptr<FileSink> makeFileSink(const std::string& path, const FileSinkOptions& options = {})
+{
+    if (options.blockCompression && options.ringSize == 0) {
+        FileSinkOptions plain = options;
+        plain.blockCompression = false;
+        auto sink = std::make_unique<CompressedFileSink>(makeFileSink(path, plain), options);
+        if (sink->isOpen()) {
+            return sink;
+        }
+    }
+
+#ifdef _WIN32
+    (void)options;
+    return std::make_unique<StreamFileSink>(path);
+#else
+    if (options.ringSize > 0) {
+        // No fallback: a growing file would break the disk budget the ring promises
+        return std::make_unique<RingFileSink>(path, options.ringSize, options.binaryRecords);
+    }
+
+    FileIoMode mode = options.ioMode;
+    if (mode == FileIoMode::STREAM) {
+        return std::make_unique<StreamFileSink>(path);
+    }
+    if (mode == FileIoMode::SHARED) {
+        // Other writers move the end of the file, so this process cannot reserve or trim space
+        FileSinkOptions shared = options;
+        shared.preallocateSize = 0;
+        shared.dropCache = false;
+        return std::make_unique<FdFileSink>(path, shared);
+    }
+
+#ifdef O_DIRECT
+    if (mode == FileIoMode::DIRECT) {
+        auto sink = std::make_unique<DirectFileSink>(path, options);
+        if (sink->isOpen()) {
+            return sink;
+        }
+    }
+#endif
+
+#ifdef ULOGGER_HAVE_IO_URING
+    if (mode == FileIoMode::IO_URING) {
+        auto sink = std::make_unique<UringFileSink>(path, options);
+        if (sink->isOpen()) {
+            return sink;
+        }
+    }
+#endif
+
+    return std::make_unique<FdFileSink>(path, options);
+#endif
+}
+
+#endif // ULOGGER_FILE_SINK_H
@@ -0,0 +1,259 @@
+#ifndef ULOGGER_FLIGHT_RECORDER_H
+#define ULOGGER_FLIGHT_RECORDER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "uLoggerBinary.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief In-memory ring of the most recent records in binary form, at every level.
+ *
+ * Each entry is a little-endian 32-bit length of the rest, the sequence
+ * number, the timestamp in microseconds, the level and the typed
+ * arguments as captured for the binary log format; nothing is formatted
+ * when a record is taken. There is one writer (the logger, under its lock).
+ * A reader needs no lock: as in the shared-memory ring, the writer moves the
+ * tail past the entries it is about to overwrite first, and the reader
+ * drops a copy the tail has passed. A crash handler can therefore dump the
+ * ring while other threads keep logging.
+ */
+struct FlightRecorder
+{
+    static constexpr size_t ENTRY_PREFIX = 4;
+    static constexpr size_t ENTRY_FIXED = 8 + 8 + 1;
+    static constexpr size_t DUMP_BUFFER_SIZE = 64 * 1024;
+
+    std::unique_ptr<char[]> ring;
+    uint64_t capacity = 0;
+    size_t maxArgs = 0;
+    std::atomic<uint64_t> head {0};
+    std::atomic<uint64_t> tail {0};
+    std::unique_ptr<char[]> entryBuffer;   // one entry copied out of the ring by a reader
+    std::unique_ptr<char[]> dumpBuffer;    // encoded output of dump()
+
+    bool isEnabled() const
+    {
+        return capacity > 0;
+    }
+
+    /**
+     * @brief Allocates a ring of @p bytes for arguments of up to @p argsLimit bytes (0 frees it).
+     *
+     * Not safe against concurrent readers; the logger only calls it with no crash handler armed.
+     */
+    void resize(size_t bytes, size_t argsLimit)
+    {
+        ring.reset();
+        entryBuffer.reset();
+        dumpBuffer.reset();
+        capacity = 0;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        if (bytes <= ENTRY_PREFIX + ENTRY_FIXED) return;
+
+        maxArgs = std::min(argsLimit, bytes - ENTRY_PREFIX - ENTRY_FIXED);
+        ring.reset(new char[bytes]);
+        entryBuffer.reset(new char[ENTRY_FIXED + maxArgs]);
+        dumpBuffer.reset(new char[DUMP_BUFFER_SIZE]);
+        capacity = bytes;
+    }
+
+    /**
+     * @brief Stores one record, dropping the oldest entries to make room.
+     */
+    void record(uint64_t sequence, int64_t micros, uint8_t level, const uint8_t* args, size_t argsSize)
+    {
+        if (argsSize > maxArgs) {
+            // Only a ring smaller than one record gets here; the cut shows as malformed arguments
+            argsSize = maxArgs;
+            level |= binlog::LEVEL_TRUNCATED;
+        }
+        uint32_t length = static_cast<uint32_t>(ENTRY_FIXED + argsSize);
+        uint64_t needed = ENTRY_PREFIX + length;
+
+        uint64_t position = head.load(std::memory_order_relaxed);
+        uint64_t oldest = tail.load(std::memory_order_relaxed);
+        if (position + needed - oldest > capacity) {
+            while (position + needed - oldest > capacity) {
+                char prefix[ENTRY_PREFIX];
+                copyOut(oldest, prefix, sizeof(prefix));
+                oldest += ENTRY_PREFIX + getLE32(prefix);
+            }
+            tail.store(oldest, std::memory_order_relaxed);
+            // Readers must see the new tail before the entries it gave up are overwritten
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        char fixed[ENTRY_PREFIX + ENTRY_FIXED];
+        for (size_t i = 0; i < ENTRY_PREFIX; ++i) {
+            fixed[i] = static_cast<char>(length >> (8 * i));
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            fixed[4 + i] = static_cast<char>(sequence >> (8 * i));
+            fixed[12 + i] = static_cast<char>(static_cast<uint64_t>(micros) >> (8 * i));
+        }
+        fixed[20] = static_cast<char>(level);
+        copyIn(position, fixed, sizeof(fixed));
+        copyIn(position + sizeof(fixed), reinterpret_cast<const char*>(args), argsSize);
+        head.store(position + needed, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the held entries into a recorder of their exact size, which can be read without the writer's lock.
+     */
+    std::unique_ptr<FlightRecorder> snapshot() const
+    {
+        auto copy = std::make_unique<FlightRecorder>();
+        if (!isEnabled()) return copy;
+        uint64_t oldest = tail.load(std::memory_order_relaxed);
+        uint64_t end = head.load(std::memory_order_relaxed);
+        if (end == oldest) return copy;
+        copy->ring.reset(new char[end - oldest]);
+        copyOut(oldest, copy->ring.get(), static_cast<size_t>(end - oldest));
+        copy->entryBuffer.reset(new char[ENTRY_FIXED + maxArgs]);
+        copy->maxArgs = maxArgs;
+        copy->capacity = end - oldest;
+        copy->head.store(end - oldest, std::memory_order_relaxed);
+        return copy;
+    }
+
+    /**
+     * @brief An entry as seen by a reader; @p args points into entryBuffer.
+     */
+    struct Entry {
+        uint64_t sequence;
+        int64_t micros;
+        uint8_t level;
+        const uint8_t* args;
+        size_t argsSize;
+    };
+
+    /**
+     * @brief Calls @p visit for every intact entry, oldest first, without allocating.
+     * @return Number of entries visited.
+     */
+    template<typename Visitor>
+    size_t forEach(Visitor&& visit)
+    {
+        if (!isEnabled()) return 0;
+        uint64_t cursor = tail.load(std::memory_order_acquire);
+        uint64_t end = head.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (cursor < end) {
+            char prefix[ENTRY_PREFIX];
+            copyOut(cursor, prefix, sizeof(prefix));
+            uint32_t length = getLE32(prefix);
+            bool plausible = length >= ENTRY_FIXED && length <= ENTRY_FIXED + maxArgs &&
+                             ENTRY_PREFIX + length <= end - cursor;
+            if (plausible) {
+                copyOut(cursor + ENTRY_PREFIX, entryBuffer.get(), length);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t reclaimed = tail.load(std::memory_order_relaxed);
+            if (reclaimed > cursor) {
+                // Overwritten while it was copied
+                cursor = reclaimed;
+                continue;
+            }
+            if (!plausible) break;
+
+            const char* data = entryBuffer.get();
+            Entry entry {};
+            for (size_t i = 0; i < 8; ++i) {
+                entry.sequence |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+                entry.micros |= static_cast<int64_t>(static_cast<uint8_t>(data[8 + i])) << (8 * i);
+            }
+            entry.level = static_cast<uint8_t>(data[16]);
+            entry.args = reinterpret_cast<const uint8_t*>(data + ENTRY_FIXED);
+            entry.argsSize = length - ENTRY_FIXED;
+            visit(entry);
+            ++count;
+            cursor += ENTRY_PREFIX + length;
+        }
+        return count;
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief Writes the ring to @p fd as a binary log (ulog-decode renders it).
+     *
+     * Async-signal-safe: only preallocated buffers and write(2) are used.
+     * @return Number of records written.
+     */
+    size_t dump(int fd, bool includeDate)
+    {
+        if (!isEnabled()) return 0;
+        uint8_t* out = reinterpret_cast<uint8_t*>(dumpBuffer.get());
+        size_t used = 0;
+        bool started = false;
+        binlog::DeltaState state;
+
+        size_t count = forEach([&](const Entry& entry) {
+            size_t worst = binlog::HEADER_SIZE + binlog::MAX_RECORD_HEAD + entry.argsSize;
+            if (used + worst > DUMP_BUFFER_SIZE) {
+                writeAll(fd, out, used);
+                used = 0;
+            }
+            if (!started) {
+                binlog::encodeHeader(out + used, state, includeDate, entry.micros, entry.sequence);
+                used += binlog::HEADER_SIZE;
+                started = true;
+            }
+            used += binlog::encodeRecordHead(out + used, state, entry.sequence, entry.micros, entry.level,
+                                             entry.argsSize);
+            std::memcpy(out + used, entry.args, entry.argsSize);
+            used += entry.argsSize;
+        });
+        writeAll(fd, out, used);
+        return count;
+    }
+
+    static void writeAll(int fd, const uint8_t* data, size_t size)
+    {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+#endif
+
+private:
+    static uint32_t getLE32(const char* in)
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    void copyIn(uint64_t position, const char* data, size_t size)
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(ring.get() + offset, data, first);
+        std::memcpy(ring.get(), data + first, size - first);
+    }
+
+    void copyOut(uint64_t position, char* data, size_t size) const
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(data, ring.get() + offset, first);
+        std::memcpy(data + first, ring.get(), size - first);
+    }
+};
+
+#endif // ULOGGER_FLIGHT_RECORDER_H
@@ -0,0 +1,136 @@
+#ifndef ULOGGER_INDEX_H
+#define ULOGGER_INDEX_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Sidecar time index of a log file.
+ *
+ * The index (log file path + ".idx") is a 16-byte header followed by fixed
+ * 24-byte entries, one for the first record of every indexed interval:
+ * timestamp (microseconds since the epoch), sequence number and the byte
+ * offset of the record in the log file, all little endian. In binary logs a
+ * header is repeated at every indexed record, so decoding can start there.
+ */
+namespace logindex {
+
+constexpr char MAGIC[8] = { 'U', 'L', 'O', 'G', 'I', 'D', 'X', '1' };
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t ENTRY_SIZE = 24;
+
+struct Entry {
+    int64_t micros = 0;
+    uint64_t sequence = 0;
+    uint64_t offset = 0;
+};
+
+inline void putLE64(char* out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+inline uint64_t getLE64(const char* in)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Returns the sidecar index path of @p logPath.
+ */
+inline std::string indexPath(const std::string& logPath)
+{
+    return logPath + ".idx";
+}
+
+/**
+ * @brief Builds the index header for entries every @p intervalSeconds.
+ */
+inline std::string encodeHeader(uint32_t intervalSeconds)
+{
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    putLE64(header + 8, intervalSeconds);
+    return std::string(header, sizeof(header));
+}
+
+inline void appendEntry(std::string& out, const Entry& entry)
+{
+    char data[ENTRY_SIZE];
+    putLE64(data, static_cast<uint64_t>(entry.micros));
+    putLE64(data + 8, entry.sequence);
+    putLE64(data + 16, entry.offset);
+    out.append(data, sizeof(data));
+}
+
+/**
+ * @brief Appends @p entries to the index at @p path, writing the header first if the file is new.
+ */
+inline bool appendEntries(const std::string& path, uint32_t intervalSeconds, const std::string& entries)
+{
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    if (!file) return false;
+    bool ok = true;
+    if (std::ftell(file) == 0) {
+        std::string header = encodeHeader(intervalSeconds);
+        ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    }
+    ok = ok && std::fwrite(entries.data(), 1, entries.size(), file) == entries.size();
+    return (std::fclose(file) == 0) && ok;
+}
+
+/**
+ * @brief Reads every complete entry of an index; false if the file is missing or not an index.
+ */
+inline bool readIndex(const std::string& path, std::vector<Entry>& entries)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    char header[HEADER_SIZE];
+    bool ok = std::fread(header, 1, sizeof(header), file) == sizeof(header) &&
+              std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0;
+    char data[ENTRY_SIZE];
+    while (ok && std::fread(data, 1, sizeof(data), file) == sizeof(data)) {
+        entries.push_back({static_cast<int64_t>(getLE64(data)), getLE64(data + 8), getLE64(data + 16)});
+    }
+    std::fclose(file);
+    return ok;
+}
+
+/**
+ * @brief Offset to start reading at for records from @p micros on (0 if none is earlier).
+ */
+inline uint64_t seekOffset(const std::vector<Entry>& entries, int64_t micros)
+{
+    uint64_t offset = 0;
+    for (const Entry& entry : entries) {
+        if (entry.micros > micros) break;
+        offset = entry.offset;
+    }
+    return offset;
+}
+
+/**
+ * @brief Offset where records after @p micros are known to start (UINT64_MAX for the file end).
+ */
+inline uint64_t endOffset(const std::vector<Entry>& entries, int64_t micros)
+{
+    for (const Entry& entry : entries) {
+        if (entry.micros > micros) return entry.offset;
+    }
+    return UINT64_MAX;
+}
+
+} // namespace logindex
+
+#endif // ULOGGER_INDEX_H
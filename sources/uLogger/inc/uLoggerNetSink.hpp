@@ -0,0 +1,332 @@
+#ifndef ULOGGER_NET_SINK_H
+#define ULOGGER_NET_SINK_H
+
+#include "uLoggerRecordSink.hpp"
+
+/**
+ * @brief Frame format of the network sink.
+ *
+ * A TCP stream, and every UDP datagram, starts with the 8-byte magic and
+ * carries frames back to back. Each frame is a little-endian 32-bit length
+ * of the rest, then the level (binlog::LEVEL_TRUNCATED set if the message
+ * was cut), the 64-bit sequence number, the 64-bit timestamp in
+ * microseconds since the epoch and the message text.
+ */
+namespace netlog {
+
+constexpr char MAGIC[8] = { 'U', 'L', 'O', 'G', 'N', 'E', 'T', '1' };
+constexpr size_t LENGTH_SIZE = 4;
+constexpr size_t FIXED_SIZE = 1 + 8 + 8;
+constexpr size_t MAX_FRAME = 1 << 20;
+
+struct Frame {
+    uint8_t level = 0;
+    bool truncated = false;
+    uint64_t sequence = 0;
+    int64_t micros = 0;
+    std::string_view message;
+};
+
+inline void appendFrame(std::string& out, LogLevel level, bool truncated, uint64_t sequence, int64_t micros,
+                        std::string_view message)
+{
+    char head[LENGTH_SIZE + FIXED_SIZE];
+    uint32_t length = static_cast<uint32_t>(FIXED_SIZE + message.size());
+    for (size_t i = 0; i < LENGTH_SIZE; ++i) {
+        head[i] = static_cast<char>(length >> (8 * i));
+    }
+    head[4] = static_cast<char>(static_cast<uint8_t>(level) | (truncated ? binlog::LEVEL_TRUNCATED : 0));
+    logindex::putLE64(head + 5, sequence);
+    logindex::putLE64(head + 13, static_cast<uint64_t>(micros));
+    out.append(head, sizeof(head));
+    out.append(message.data(), message.size());
+}
+
+/**
+ * @brief Splits frames off the front of a byte stream.
+ */
+struct FrameReader {
+    std::string pending;
+    size_t offset = 0;
+    bool sawMagic = false;
+    bool corrupt = false;
+
+    void feed(const char* data, size_t size)
+    {
+        if (offset > 0 && offset == pending.size()) {
+            pending.clear();
+            offset = 0;
+        } else if (offset > (1 << 16)) {
+            pending.erase(0, offset);
+            offset = 0;
+        }
+        pending.append(data, size);
+    }
+
+    /**
+     * @brief Returns the next complete frame; its message points into the reader.
+     */
+    bool next(Frame& frame)
+    {
+        if (corrupt) return false;
+        if (!sawMagic) {
+            if (pending.size() - offset < sizeof(MAGIC)) return false;
+            if (std::memcmp(pending.data() + offset, MAGIC, sizeof(MAGIC)) != 0) {
+                corrupt = true;
+                return false;
+            }
+            offset += sizeof(MAGIC);
+            sawMagic = true;
+        }
+        if (pending.size() - offset < LENGTH_SIZE) return false;
+        const char* data = pending.data() + offset;
+        uint32_t length = 0;
+        for (size_t i = 0; i < LENGTH_SIZE; ++i) {
+            length |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        if (length < FIXED_SIZE || length > MAX_FRAME) {
+            corrupt = true;
+            return false;
+        }
+        if (pending.size() - offset < LENGTH_SIZE + length) return false;
+        uint8_t level = static_cast<uint8_t>(data[4]);
+        frame.level = level & ~binlog::LEVEL_TRUNCATED;
+        frame.truncated = (level & binlog::LEVEL_TRUNCATED) != 0;
+        frame.sequence = logindex::getLE64(data + 5);
+        frame.micros = static_cast<int64_t>(logindex::getLE64(data + 13));
+        frame.message = std::string_view(data + LENGTH_SIZE + FIXED_SIZE, length - FIXED_SIZE);
+        offset += LENGTH_SIZE + length;
+        return true;
+    }
+};
+
+} // namespace netlog
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/**
+ * @brief Transport of a NetworkSink.
+ */
+enum class NetworkProtocol {
+    TCP,    /**< One stream; records lost only if the connection drops with data in flight. */
+    UDP     /**< Datagrams of packed frames; no connection, no delivery guarantee. */
+};
+
+/**
+ * @brief Tuning of a NetworkSink.
+ */
+struct NetworkSinkOptions {
+    NetworkProtocol protocol = NetworkProtocol::TCP;
+    size_t queueCapacity = 65536;   /**< Records buffered while the collector is slow or away. */
+    size_t maxBatch = 256;          /**< Records per send. */
+    size_t maxDatagram = 1400;      /**< UDP payload size that frames are packed into. */
+    std::chrono::milliseconds ioTimeout {1000};   /**< Connect and send timeout. */
+};
+
+/**
+ * @brief Ships records to a collector over TCP or UDP in length-prefixed frames.
+ *
+ * Records are queued by AsyncRecordSink and sent from the sink thread, many
+ * frames per system call, so LOG_PRINT never waits for the network. While
+ * the collector is unreachable the sink reconnects with exponential backoff
+ * and holds up to queueCapacity records; beyond that records are dropped
+ * and counted. After a broken TCP connection, the frames that were not
+ * completely written are sent again on the new one.
+ */
+struct NetworkSink : AsyncRecordSink
+{
+    NetworkSink(std::string collectorHost, uint16_t collectorPort, const NetworkSinkOptions& sinkOptions = {})
+        : AsyncRecordSink(sinkOptions.queueCapacity, sinkOptions.maxBatch),
+          host(std::move(collectorHost)), port(collectorPort), options(sinkOptions)
+    {
+    }
+
+    ~NetworkSink() override
+    {
+        stop();
+        closeSocket();
+    }
+
+    void childAfterFork() override
+    {
+        AsyncRecordSink::childAfterFork();
+        // Frames of both processes on one TCP stream would interleave; the child connects on its own
+        closeSocket();
+    }
+
+protected:
+    bool send(std::vector<Entry>& batch) override
+    {
+        if (fd >= 0 && options.protocol == NetworkProtocol::TCP && peerClosed()) {
+            closeSocket();
+        }
+        if (fd < 0 && !connectSocket()) {
+            return false;
+        }
+        return (options.protocol == NetworkProtocol::TCP) ? sendStream(batch) : sendDatagrams(batch);
+    }
+
+private:
+    static int64_t microsOf(const Entry& entry)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(entry.time.time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Returns true if the collector has closed the connection.
+     *
+     * A write into a closed connection still succeeds once before the reset
+     * arrives, losing that batch; the collector never sends data, so a
+     * readable socket means it is gone.
+     */
+    bool peerClosed() const
+    {
+        pollfd waiter {fd, POLLIN, 0};
+        return ::poll(&waiter, 1, 0) > 0;
+    }
+
+    bool sendStream(std::vector<Entry>& batch)
+    {
+        // Frame ends let a broken connection resume at the first frame not fully written
+        frames.clear();
+        frameEnds.clear();
+        if (!greeted) {
+            frames.append(netlog::MAGIC, sizeof(netlog::MAGIC));
+        }
+        for (const Entry& entry : batch) {
+            netlog::appendFrame(frames, entry.level, entry.truncated, entry.sequence, microsOf(entry), entry.message);
+            frameEnds.push_back(frames.size());
+        }
+
+        size_t written = 0;
+        while (written < frames.size()) {
+            ssize_t result = ::send(fd, frames.data() + written, frames.size() - written, MSG_NOSIGNAL);
+            if (result > 0) {
+                written += static_cast<size_t>(result);
+                greeted = true;
+                continue;
+            }
+            if (result < 0 && errno == EINTR) continue;
+
+            // Timed out or broken: a partial frame poisons the stream, so start a new connection
+            closeSocket();
+            size_t done = 0;
+            while (done < frameEnds.size() && frameEnds[done] <= written) {
+                ++done;
+            }
+            batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(done));
+            return false;
+        }
+        return true;
+    }
+
+    bool sendDatagrams(std::vector<Entry>& batch)
+    {
+        size_t packed = 0;
+        while (packed < batch.size()) {
+            frames.assign(netlog::MAGIC, sizeof(netlog::MAGIC));
+            size_t first = packed;
+            while (packed < batch.size()) {
+                const Entry& entry = batch[packed];
+                size_t frameSize = netlog::LENGTH_SIZE + netlog::FIXED_SIZE + entry.message.size();
+                if (packed > first && frames.size() + frameSize > options.maxDatagram) break;
+                netlog::appendFrame(frames, entry.level, entry.truncated, entry.sequence, microsOf(entry),
+                                    entry.message);
+                ++packed;
+            }
+
+            ssize_t result;
+            do {
+                result = ::send(fd, frames.data(), frames.size(), 0);
+            } while (result < 0 && errno == EINTR);
+            if (result >= 0) continue;
+            if (errno == EMSGSIZE) {
+                dropped.fetch_add(packed - first, std::memory_order_relaxed);
+                continue;
+            }
+            // ECONNREFUSED means nobody listens (yet): keep the rest for a retry
+            closeSocket();
+            batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(first));
+            return false;
+        }
+        return true;
+    }
+
+    bool connectSocket()
+    {
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = (options.protocol == NetworkProtocol::TCP) ? SOCK_STREAM : SOCK_DGRAM;
+        addrinfo* addresses = nullptr;
+        std::string service = std::to_string(port);
+        if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+            return false;
+        }
+        for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+            fd = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, address->ai_protocol);
+            if (fd < 0) continue;
+            if (!connectWithTimeout(address->ai_addr, address->ai_addrlen)) {
+                closeSocket();
+            }
+        }
+        ::freeaddrinfo(addresses);
+        return fd >= 0;
+    }
+
+    /**
+     * @brief Connects the non-blocking socket within ioTimeout, then makes it blocking with a send timeout.
+     */
+    bool connectWithTimeout(const sockaddr* address, socklen_t length)
+    {
+        if (::connect(fd, address, length) != 0) {
+            if (errno != EINPROGRESS) return false;
+            pollfd waiter {fd, POLLOUT, 0};
+            if (::poll(&waiter, 1, static_cast<int>(options.ioTimeout.count())) != 1) return false;
+            int error = 0;
+            socklen_t size = sizeof(error);
+            ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size);
+            if (error != 0) return false;
+        }
+
+        int flags = ::fcntl(fd, F_GETFL);
+        ::fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(options.ioTimeout);
+        timeval timeout {static_cast<time_t>(seconds.count()),
+                         static_cast<suseconds_t>((options.ioTimeout - seconds).count() * 1000)};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (options.protocol == NetworkProtocol::TCP) {
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+        greeted = false;
+        return true;
+    }
+
+    void closeSocket()
+    {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    std::string host;
+    uint16_t port;
+    NetworkSinkOptions options;
+    int fd = -1;
+    bool greeted = false;   // magic sent on the current connection
+    std::string frames;
+    std::vector<size_t> frameEnds;
+};
+#endif
+
+#endif // ULOGGER_NET_SINK_H
@@ -0,0 +1,266 @@
+#ifndef ULOGGER_RECORD_SINK_H
+#define ULOGGER_RECORD_SINK_H
+
+#include "uLogger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Record sink that queues records and sends them in batches from its own thread.
+ *
+ * consume() only copies the record into a bounded queue, so the logger lock
+ * is never held across a system call. When the queue is full the record is
+ * dropped and counted. A batch send() could not deliver is kept and retried
+ * with exponential backoff while new records queue up behind it. The thread
+ * starts with the first record; derived sinks implement send() and call
+ * stop() in their destructor.
+ */
+struct AsyncRecordSink : RecordSink
+{
+    struct Entry {
+        LogLevel level = LOG_INFO;
+        uint64_t sequence = 0;
+        std::chrono::system_clock::time_point time;
+        bool truncated = false;
+        std::string message;
+    };
+
+    static constexpr auto RETRY_MIN = std::chrono::milliseconds(100);
+    static constexpr auto RETRY_MAX = std::chrono::milliseconds(10000);
+
+    explicit AsyncRecordSink(size_t queueCapacity = 8192, size_t maxBatch = 64)
+        : capacity(queueCapacity), batchSize(maxBatch)
+    {
+    }
+
+    ~AsyncRecordSink() override
+    {
+        stop();
+    }
+
+    void consume(const LogRecord& record) override
+    {
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (queue.size() >= capacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Entry entry;
+            if (!spare.empty()) {
+                // Reuse the message buffers of sent records
+                entry.message = std::move(spare.back());
+                spare.pop_back();
+            }
+            entry.level = record.level;
+            entry.sequence = record.sequence;
+            entry.time = record.time;
+            entry.truncated = record.truncated;
+            entry.message.assign(record.message.data(), record.message.size());
+            // The thread only sleeps on an empty queue, so only the first record needs to wake it
+            wake = queue.empty();
+            queue.push_back(std::move(entry));
+            if (!running) {
+                running = true;
+                stopping = false;
+                thread = std::thread([this] { run(); });
+            }
+        }
+        if (wake) {
+            ready.notify_one();
+        }
+    }
+
+    /**
+     * @brief Blocks until every queued record has been sent.
+     */
+    void waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        idle.wait(lock, [this] { return isIdleLocked(); });
+    }
+
+    /**
+     * @brief Waits until every queued record has been sent or @p deadline passes.
+     * @return True if the queue drained in time.
+     */
+    bool waitIdleUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        return idle.wait_until(lock, deadline, [this] { return isIdleLocked(); });
+    }
+
+    /**
+     * @brief Sends the queued records and stops, or gives up on them when @p deadline passes.
+     *
+     * When send() is stuck the thread is told to stop and left to finish on
+     * its own; the records in the batch it is sending count as dropped.
+     */
+    ShutdownReport shutdown(std::chrono::steady_clock::time_point deadline) override
+    {
+        ShutdownReport report;
+        if (waitIdleUntil(deadline)) {
+            stop();
+            return report;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            uint64_t abandoned = queue.size() + batch.size();
+            dropped.fetch_add(abandoned, std::memory_order_relaxed);
+            report.droppedRecords = abandoned + inFlight;
+            report.complete = false;
+            queue.clear();
+            batch.clear();
+            stopping = true;
+        }
+        ready.notify_one();
+        return report;
+    }
+
+    /**
+     * @brief Makes one last attempt at the remaining records, drops what is left and joins the thread.
+     */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!running) return;
+            stopping = true;
+        }
+        ready.notify_one();
+        thread.join();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            running = false;
+        }
+        idle.notify_all();
+    }
+
+    void prepareFork() override
+    {
+        queueMutex.lock();
+    }
+
+    void parentAfterFork() override
+    {
+        queueMutex.unlock();
+    }
+
+    /**
+     * @brief Starts over in a forked child: the queued records are the parent's to send.
+     *
+     * The thread starts again with the child's first record.
+     */
+    void childAfterFork() override
+    {
+        queue.clear();
+        batch.clear();
+        // The copied thread handle and condition variables refer to threads that do not exist here
+        new (&thread) std::thread();
+        new (&ready) std::condition_variable();
+        new (&idle) std::condition_variable();
+        running = false;
+        sending = false;
+        inFlight = 0;
+        stopping = false;
+        queueMutex.unlock();
+    }
+
+    /**
+     * @brief Records dropped because the queue was full or the destination refused them.
+     */
+    uint64_t droppedRecords() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+protected:
+    /**
+     * @brief Sends a batch of records; runs on the sink thread only.
+     *
+     * Delivered records are erased from the front of @p batch; returning
+     * false keeps the rest for a retry after the backoff delay.
+     */
+    virtual bool send(std::vector<Entry>& batch) = 0;
+
+    std::atomic<uint64_t> dropped {0};
+
+private:
+    bool isIdleLocked() const
+    {
+        return !running || (queue.empty() && !sending && batch.empty());
+    }
+
+    void run()
+    {
+        auto backoff = std::chrono::milliseconds(RETRY_MIN);
+        std::unique_lock<std::mutex> lock(queueMutex);
+        for (;;) {
+            if (!queue.empty() || !batch.empty()) {
+                while (!queue.empty() && batch.size() < batchSize) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+                std::vector<Entry> sendable;
+                sendable.swap(batch);
+                sending = true;
+                inFlight = sendable.size();
+                lock.unlock();
+                bool delivered = send(sendable);
+                lock.lock();
+                sending = false;
+                inFlight = 0;
+                if (delivered) {
+                    for (Entry& entry : sendable) {
+                        if (spare.size() < 4 * batchSize) {
+                            spare.push_back(std::move(entry.message));
+                        }
+                    }
+                    backoff = RETRY_MIN;
+                    continue;
+                }
+
+                batch.swap(sendable);
+                if (stopping) {
+                    dropped.fetch_add(batch.size() + queue.size(), std::memory_order_relaxed);
+                    batch.clear();
+                    queue.clear();
+                    return;
+                }
+                // Records keep queueing meanwhile; only stop() cuts the wait short
+                ready.wait_for(lock, backoff, [this] { return stopping; });
+                backoff = std::min(backoff * 2, std::chrono::milliseconds(RETRY_MAX));
+                continue;
+            }
+
+            if (stopping) return;
+            idle.notify_all();
+            ready.wait(lock);
+        }
+    }
+
+    size_t capacity;
+    size_t batchSize;
+    std::thread thread;
+    std::mutex queueMutex;
+    std::condition_variable ready;
+    std::condition_variable idle;
+    std::deque<Entry> queue;
+    std::vector<Entry> batch;    // taken from the queue, not yet delivered
+    std::vector<std::string> spare;
+    bool running = false;
+    bool sending = false;
+    size_t inFlight = 0;   // records in the batch send() is working on
+    bool stopping = false;
+};
+
+#endif // ULOGGER_RECORD_SINK_H
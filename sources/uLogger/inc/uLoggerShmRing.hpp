@@ -0,0 +1,389 @@
+#ifndef ULOGGER_SHM_RING_H
+#define ULOGGER_SHM_RING_H
+
+#include "uLogger.hpp"
+
+#ifndef _WIN32
+#include <atomic>
+#include <cerrno>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Shared-memory ring of log records for out-of-process readers.
+ *
+ * The POSIX shared-memory object holds a page-sized header and a data area
+ * the producer writes records into circularly. Positions are byte counts
+ * since the ring was created and only ever grow; the data offset is the
+ * position modulo the capacity. Each record is a little-endian 32-bit
+ * length of the rest, then the ring-local record index (64 bits), the level
+ * (LEVEL_TRUNCATED set if the message was cut), the logger's sequence
+ * number, the timestamp in microseconds since the epoch and the message.
+ *
+ * There is one producer and any number of readers, and nobody waits for
+ * anybody. Before overwriting old records the producer moves the tail past
+ * them. A reader copies a record out, then checks the tail; if the tail
+ * passed the record meanwhile, the copy may be torn and is discarded. Gaps
+ * in the record indexes tell the reader exactly how many records it missed.
+ */
+namespace shmlog {
+
+constexpr char MAGIC[8] = { 'U', 'L', 'O', 'G', 'S', 'H', 'M', '1' };
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 4096;
+constexpr size_t LENGTH_SIZE = 4;
+constexpr size_t FIXED_SIZE = 8 + 1 + 8 + 8;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring header needs address-free 64-bit atomics");
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;                 /**< Size of the data area. */
+    uint64_t producerPid;
+    std::atomic<uint64_t> head;        /**< End of the last published record. */
+    std::atomic<uint64_t> tail;        /**< Start of the oldest record still intact. */
+    std::atomic<uint32_t> closed;      /**< Set when the producer has gone. */
+};
+
+/**
+ * @brief Returns the shared-memory object name for a ring name ("app" -> "/ulog.app").
+ */
+inline std::string objectName(const std::string& name)
+{
+    return (name.empty() || name[0] != '/') ? "/ulog." + name : name;
+}
+
+/**
+ * @brief A record copied out of the ring.
+ */
+struct Record {
+    uint64_t index = 0;
+    uint8_t level = 0;
+    bool truncated = false;
+    uint64_t sequence = 0;
+    int64_t micros = 0;
+    std::string message;
+};
+
+/**
+ * @brief Maps an existing ring read-only and follows it.
+ *
+ * A reader starts at the oldest record (or at the newest, after
+ * skipToEnd()) and never slows the producer down; records overwritten
+ * before it got to them are counted in lost.
+ */
+struct Reader {
+    const char* map = nullptr;
+    size_t mapSize = 0;
+    const Header* header = nullptr;
+    const char* ring = nullptr;
+    uint64_t capacity = 0;
+    uint64_t cursor = 0;
+    uint64_t nextIndex = 0;
+    bool started = false;
+    uint64_t lost = 0;
+    ino_t inode = 0;
+    std::string frame;
+
+    Reader() = default;
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ~Reader()
+    {
+        close();
+    }
+
+    /**
+     * @brief Maps the ring called @p name; false if it does not exist or is not a ring.
+     */
+    bool open(const std::string& name)
+    {
+        close();
+        int fd = ::shm_open(objectName(name).c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) return false;
+        struct stat st {};
+        bool ok = ::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > HEADER_SIZE;
+        if (ok) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            ok = mapped != MAP_FAILED;
+            if (ok) {
+                map = static_cast<const char*>(mapped);
+                mapSize = static_cast<size_t>(st.st_size);
+                inode = st.st_ino;
+            }
+        }
+        ::close(fd);
+        if (!ok) return false;
+
+        header = reinterpret_cast<const Header*>(map);
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+            header->capacity != mapSize - HEADER_SIZE) {
+            close();
+            return false;
+        }
+        ring = map + HEADER_SIZE;
+        capacity = header->capacity;
+        cursor = header->tail.load(std::memory_order_acquire);
+        // In a ring that has not dropped anything yet, the reader owes every record from index 0 on
+        started = cursor == 0;
+        nextIndex = 0;
+        lost = 0;
+        return true;
+    }
+
+    void close()
+    {
+        if (map) {
+            ::munmap(const_cast<char*>(map), mapSize);
+            map = nullptr;
+            header = nullptr;
+            ring = nullptr;
+        }
+    }
+
+    bool isOpen() const
+    {
+        return map != nullptr;
+    }
+
+    /**
+     * @brief Skips the records already in the ring.
+     */
+    void skipToEnd()
+    {
+        Record record;
+        while (next(record)) {
+        }
+        lost = 0;
+    }
+
+    /**
+     * @brief True if the producer has closed this ring.
+     */
+    bool isClosed() const
+    {
+        return !header || header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * @brief True if a new producer has published another ring under @p name.
+     */
+    bool isReplaced(const std::string& name) const
+    {
+        struct stat st {};
+        int fd = ::shm_open(objectName(name).c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) return false;
+        bool replaced = ::fstat(fd, &st) == 0 && st.st_ino != inode;
+        ::close(fd);
+        return replaced;
+    }
+
+    /**
+     * @brief Copies the next record out; false if the reader has caught up.
+     */
+    bool next(Record& record)
+    {
+        if (!header) return false;
+        for (;;) {
+            uint64_t head = header->head.load(std::memory_order_acquire);
+            if (cursor >= head) return false;
+            uint64_t tail = header->tail.load(std::memory_order_acquire);
+            if (cursor < tail) {
+                cursor = tail;
+                continue;
+            }
+
+            char prefix[LENGTH_SIZE];
+            copyOut(cursor, prefix, sizeof(prefix));
+            uint32_t length = 0;
+            for (size_t i = 0; i < LENGTH_SIZE; ++i) {
+                length |= static_cast<uint32_t>(static_cast<uint8_t>(prefix[i])) << (8 * i);
+            }
+            bool plausible = length >= FIXED_SIZE && LENGTH_SIZE + length <= head - cursor;
+            if (plausible) {
+                frame.resize(length);
+                copyOut(cursor + LENGTH_SIZE, frame.data(), length);
+            }
+            // The copy only counts if the producer did not reclaim the record while it was taken
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t reclaimed = header->tail.load(std::memory_order_relaxed);
+            if (reclaimed > cursor) {
+                cursor = reclaimed;
+                continue;
+            }
+            if (!plausible) {
+                // A consistent copy always has a plausible length; give up rather than spin
+                return false;
+            }
+
+            const char* data = frame.data();
+            record.index = logindex::getLE64(data);
+            uint8_t level = static_cast<uint8_t>(data[8]);
+            record.level = level & ~binlog::LEVEL_TRUNCATED;
+            record.truncated = (level & binlog::LEVEL_TRUNCATED) != 0;
+            record.sequence = logindex::getLE64(data + 9);
+            record.micros = static_cast<int64_t>(logindex::getLE64(data + 17));
+            record.message.assign(data + FIXED_SIZE, length - FIXED_SIZE);
+            // Indexes skipped since the previous record were overwritten before we got to them
+            if (started && record.index > nextIndex) {
+                lost += record.index - nextIndex;
+            }
+            started = true;
+            nextIndex = record.index + 1;
+            cursor += LENGTH_SIZE + length;
+            return true;
+        }
+    }
+
+private:
+    void copyOut(uint64_t position, char* data, size_t size) const
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(data, ring + offset, first);
+        std::memcpy(data + first, ring, size - first);
+    }
+};
+
+} // namespace shmlog
+
+/**
+ * @brief Record sink publishing into a shared-memory ring (see shmlog).
+ *
+ * consume() copies the record into the mapping under the logger lock and
+ * returns; there is no system call and no waiting on readers. A new sink
+ * replaces any ring left under the same name; readers still mapping the old
+ * one can tell with Reader::isReplaced(). The ring stays readable after the
+ * sink is gone.
+ */
+struct ShmRingSink : RecordSink
+{
+    ShmRingSink(const std::string& name, size_t ringSize)
+        : objectPath(shmlog::objectName(name)), capacity(ringSize)
+    {
+        if (ringSize <= shmlog::LENGTH_SIZE + shmlog::FIXED_SIZE) return;
+        ::shm_unlink(objectPath.c_str());
+        int fd = ::shm_open(objectPath.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) return;
+        mapSize = shmlog::HEADER_SIZE + ringSize;
+        void* mapped = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(mapSize)) == 0) {
+            mapped = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            ::shm_unlink(objectPath.c_str());
+            return;
+        }
+        map = static_cast<char*>(mapped);
+        ring = map + shmlog::HEADER_SIZE;
+        header = new (map) shmlog::Header {};
+        header->version = shmlog::VERSION;
+        header->capacity = capacity;
+        header->producerPid = static_cast<uint64_t>(::getpid());
+        // Readers recognize the ring only once it is fully set up
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, shmlog::MAGIC, sizeof(shmlog::MAGIC));
+    }
+
+    ~ShmRingSink() override
+    {
+        if (map) {
+            header->closed.store(1, std::memory_order_release);
+            ::munmap(map, mapSize);
+        }
+    }
+
+    bool isOpen() const
+    {
+        return map != nullptr;
+    }
+
+    /**
+     * @brief Stops publishing in a forked child: a ring has a single producer.
+     *
+     * The child can add a ShmRingSink of its own.
+     */
+    void childAfterFork() override
+    {
+        if (map) {
+            ::munmap(map, mapSize);
+            map = nullptr;
+        }
+    }
+
+    void consume(const LogRecord& record) override
+    {
+        if (!map) return;
+        size_t room = static_cast<size_t>(capacity) - shmlog::LENGTH_SIZE - shmlog::FIXED_SIZE;
+        size_t messageSize = std::min(record.message.size(), room);
+        bool truncated = record.truncated || messageSize < record.message.size();
+        uint32_t length = static_cast<uint32_t>(shmlog::FIXED_SIZE + messageSize);
+        uint64_t needed = shmlog::LENGTH_SIZE + length;
+
+        // Only this thread stores head and tail, so relaxed loads see its own values
+        uint64_t head = header->head.load(std::memory_order_relaxed);
+        uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        if (head + needed - tail > capacity) {
+            while (head + needed - tail > capacity) {
+                char prefix[shmlog::LENGTH_SIZE];
+                copyOut(tail, prefix, sizeof(prefix));
+                uint32_t old = 0;
+                for (size_t i = 0; i < shmlog::LENGTH_SIZE; ++i) {
+                    old |= static_cast<uint32_t>(static_cast<uint8_t>(prefix[i])) << (8 * i);
+                }
+                tail += shmlog::LENGTH_SIZE + old;
+            }
+            header->tail.store(tail, std::memory_order_relaxed);
+            // Readers must see the new tail before any byte of the records it gave up is overwritten
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        char fixed[shmlog::LENGTH_SIZE + shmlog::FIXED_SIZE];
+        for (size_t i = 0; i < shmlog::LENGTH_SIZE; ++i) {
+            fixed[i] = static_cast<char>(length >> (8 * i));
+        }
+        logindex::putLE64(fixed + 4, nextIndex++);
+        fixed[12] = static_cast<char>(static_cast<uint8_t>(record.level) | (truncated ? binlog::LEVEL_TRUNCATED : 0));
+        logindex::putLE64(fixed + 13, record.sequence);
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count();
+        logindex::putLE64(fixed + 21, static_cast<uint64_t>(micros));
+        copyIn(head, fixed, sizeof(fixed));
+        copyIn(head + sizeof(fixed), record.message.data(), messageSize);
+        header->head.store(head + needed, std::memory_order_release);
+    }
+
+private:
+    void copyIn(uint64_t position, const char* data, size_t size)
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(ring + offset, data, first);
+        std::memcpy(ring, data + first, size - first);
+    }
+
+    void copyOut(uint64_t position, char* data, size_t size) const
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min<size_t>(size, static_cast<size_t>(capacity) - offset);
+        std::memcpy(data, ring + offset, first);
+        std::memcpy(data + first, ring, size - first);
+    }
+
+    std::string objectPath;
+    uint64_t capacity = 0;
+    size_t mapSize = 0;
+    char* map = nullptr;
+    char* ring = nullptr;
+    shmlog::Header* header = nullptr;
+    uint64_t nextIndex = 0;
+};
+#endif
+
+#endif // ULOGGER_SHM_RING_H
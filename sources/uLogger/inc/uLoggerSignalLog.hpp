@@ -0,0 +1,315 @@
+#ifndef ULOGGER_SIGNAL_LOG_H
+#define ULOGGER_SIGNAL_LOG_H
+
+#ifndef _WIN32
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Helpers usable from signal handlers: no locks, no allocation, no locale.
+ */
+namespace sigsafe {
+
+/**
+ * @brief Returns the current time in microseconds since the epoch.
+ */
+inline int64_t nowMicros()
+{
+    timespec clock {};
+    ::clock_gettime(CLOCK_REALTIME, &clock);
+    return static_cast<int64_t>(clock.tv_sec) * 1'000'000 + clock.tv_nsec / 1000;
+}
+
+/**
+ * @brief Writes @p value in decimal, zero-padded to @p width; returns the length.
+ */
+inline size_t putDecimal(char* out, uint64_t value, size_t width = 0)
+{
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    size_t length = 0;
+    for (; width > count; --width) {
+        out[length++] = '0';
+    }
+    while (count > 0) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+/**
+ * @brief Writes @p value as 0x followed by upper-case hex digits; returns the length.
+ */
+inline size_t putHex(char* out, uint64_t value)
+{
+    char digits[16];
+    size_t count = 0;
+    do {
+        digits[count++] = "0123456789ABCDEF"[value & 0xF];
+        value >>= 4;
+    } while (value > 0);
+    out[0] = '0';
+    out[1] = 'x';
+    size_t length = 2;
+    while (count > 0) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+/**
+ * @brief Formats the "date time.micros | " record prefix without localtime_r(); returns the length.
+ *
+ * @p utcOffset is the local offset in seconds east of UTC, looked up
+ * beforehand; @p out needs room for 32 bytes.
+ */
+inline size_t putTimestamp(char* out, int64_t micros, long utcOffset, bool withDate)
+{
+    int64_t local = micros / 1'000'000 + utcOffset;
+    int64_t days = local / 86400;
+    int64_t seconds = local % 86400;
+    size_t length = 0;
+    if (withDate) {
+        // Civil date from days since 1970-01-01
+        int64_t z = days + 719468;
+        int64_t era = z / 146097;
+        int64_t dayOfEra = z - era * 146097;
+        int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int64_t mp = (5 * dayOfYear + 2) / 153;
+        int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+        int64_t month = mp < 10 ? mp + 3 : mp - 9;
+        int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+        length += putDecimal(out + length, static_cast<uint64_t>(year), 4);
+        out[length++] = '-';
+        length += putDecimal(out + length, static_cast<uint64_t>(month), 2);
+        out[length++] = '-';
+        length += putDecimal(out + length, static_cast<uint64_t>(day), 2);
+        out[length++] = ' ';
+    }
+    length += putDecimal(out + length, static_cast<uint64_t>(seconds / 3600), 2);
+    out[length++] = ':';
+    length += putDecimal(out + length, static_cast<uint64_t>(seconds / 60 % 60), 2);
+    out[length++] = ':';
+    length += putDecimal(out + length, static_cast<uint64_t>(seconds % 60), 2);
+    out[length++] = '.';
+    length += putDecimal(out + length, static_cast<uint64_t>(micros % 1'000'000), 6);
+    std::memcpy(out + length, " | ", 3);
+    return length + 3;
+}
+
+/**
+ * @brief Writes all of @p size bytes to @p fd, retrying after interruptions.
+ */
+inline void writeAll(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace sigsafe
+
+/**
+ * @brief Marks an integer for LOG_SIGNAL to print in hex, like LOG_HEX32 and friends.
+ */
+struct SignalHex {
+    uint64_t value;
+};
+
+template<typename T>
+SignalHex signalHex(T value)
+{
+    return SignalHex {static_cast<uint64_t>(static_cast<typename std::make_unsigned<T>::type>(value))};
+}
+
+/**
+ * @brief Preallocated slots for records logged where LOG_PRINT cannot be used.
+ *
+ * A writer claims the next slot with a compare-and-swap, formats its
+ * record into the slot and publishes it; it never waits for another thread,
+ * so it can run in a signal handler, even one that interrupted a writer.
+ * A writer that keeps losing the race to other writers gives up after
+ * CLAIM_ATTEMPTS tries, so every call finishes in a bounded number of
+ * steps. When every slot is still waiting to be drained, or the tries run
+ * out, the record is dropped and counted. The logger drains published
+ * slots in order, under its lock.
+ */
+struct SignalLog
+{
+    static constexpr size_t TEXT_SIZE = 232;
+    static constexpr int CLAIM_ATTEMPTS = 64;
+
+    struct Slot {
+        std::atomic<uint64_t> state {0};   // position it can be claimed at, or that position + 1 once published
+        int64_t micros = 0;
+        uint8_t level = 0;
+        bool truncated = false;
+        uint16_t size = 0;
+        char text[TEXT_SIZE];
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "signal-safe logging needs lock-free 64-bit atomics");
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount = 0;
+    std::atomic<uint64_t> writePosition {0};
+    uint64_t readPosition = 0;   // drain side only
+    std::atomic<uint64_t> dropped {0};
+
+    bool isEnabled() const
+    {
+        return slotCount > 0;
+    }
+
+    /**
+     * @brief Allocates @p count slots (0 frees them); not while writers may be running.
+     */
+    void resize(size_t count)
+    {
+        slots.reset(count > 0 ? new Slot[count] : nullptr);
+        slotCount = count;
+        for (size_t i = 0; i < count; ++i) {
+            slots[i].state.store(i, std::memory_order_relaxed);
+        }
+        writePosition.store(0, std::memory_order_relaxed);
+        readPosition = 0;
+    }
+
+    /**
+     * @brief Claims a slot, or returns nullptr (and counts a drop) if all are in use or other writers keep winning.
+     */
+    Slot* claim(uint64_t& position)
+    {
+        if (!isEnabled()) return nullptr;
+        position = writePosition.load(std::memory_order_relaxed);
+        for (int attempt = 0; attempt < CLAIM_ATTEMPTS; ++attempt) {
+            Slot& slot = slots[position % slotCount];
+            uint64_t state = slot.state.load(std::memory_order_acquire);
+            if (state == position) {
+                if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return &slot;
+                }
+            } else if (state < position) {
+                // Still holds a record from the previous lap
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                position = writePosition.load(std::memory_order_relaxed);
+            }
+        }
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    static void publish(Slot& slot, uint64_t position)
+    {
+        slot.state.store(position + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief True if the next slot in order has been published.
+     */
+    bool hasPending() const
+    {
+        return isEnabled() &&
+               slots[readPosition % slotCount].state.load(std::memory_order_acquire) == readPosition + 1;
+    }
+
+    /**
+     * @brief Calls @p consume for each published slot, in order, and frees it; drain side only.
+     * @return Number of records drained.
+     */
+    template<typename Consumer>
+    size_t drain(Consumer&& consume)
+    {
+        size_t count = 0;
+        while (hasPending()) {
+            Slot& slot = slots[readPosition % slotCount];
+            consume(slot);
+            slot.state.store(readPosition + slotCount, std::memory_order_release);
+            ++readPosition;
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Formats arguments the way append() does: each followed by a space.
+     */
+    struct Formatter {
+        char* out;
+        size_t capacity;
+        size_t size = 0;
+        bool truncated = false;
+
+        void put(const char* data, size_t length)
+        {
+            if (size + length + 1 > capacity) {
+                length = capacity - 1 > size ? capacity - 1 - size : 0;
+                truncated = true;
+            }
+            std::memcpy(out + size, data, length);
+            size += length;
+            if (size + 1 <= capacity && !truncated) {
+                out[size++] = ' ';
+            }
+        }
+
+        void add(const char* text)
+        {
+            if (text) {
+                put(text, std::strlen(text));
+            }
+        }
+
+        void add(bool value)
+        {
+            add(value ? "true" : "false");
+        }
+
+        void add(char value)
+        {
+            put(&value, 1);
+        }
+
+        void add(SignalHex value)
+        {
+            char digits[24];
+            put(digits, sigsafe::putHex(digits, value.value));
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value>::type add(T value)
+        {
+            char digits[24];
+            size_t length = 0;
+            uint64_t magnitude = static_cast<uint64_t>(value);
+            if constexpr (std::is_signed<T>::value) {
+                if (value < 0) {
+                    digits[length++] = '-';
+                    magnitude = 0 - magnitude;
+                }
+            }
+            length += sigsafe::putDecimal(digits + length, magnitude);
+            put(digits, length);
+        }
+    };
+};
+#endif
+
+#endif // ULOGGER_SIGNAL_LOG_H
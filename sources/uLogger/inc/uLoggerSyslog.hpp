@@ -0,0 +1,267 @@
+#ifndef ULOGGER_SYSLOG_H
+#define ULOGGER_SYSLOG_H
+
+#include "uLoggerRecordSink.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief Wire format of a SyslogSink.
+ */
+enum class SyslogProtocol {
+    AUTO,        /**< journald if its socket exists, otherwise syslog. */
+    JOURNALD,    /**< Native journal fields on /run/systemd/journal/socket. */
+    SYSLOG       /**< RFC 3164 lines on /dev/log. */
+};
+
+/**
+ * @brief Sends records to the local journal or syslog daemon over its datagram socket.
+ *
+ * Unlike syslog(3) there is no libc lock and no second formatting pass: each
+ * record becomes one datagram, and a batch leaves in one sendmmsg() call.
+ * The journald encoding carries the level, tag and sequence number as their
+ * own fields:
+ *
+ *     PRIORITY=3
+ *     SYSLOG_IDENTIFIER=<tag>
+ *     ULOG_LEVEL=ERROR
+ *     ULOG_SEQUENCE=1234
+ *     ULOG_TIMESTAMP=<microseconds since the epoch>
+ *     MESSAGE=<arguments>
+ *
+ * While the daemon is away, e.g. restarting, records wait in the queue and
+ * the sink reconnects with backoff. Records a stalled daemon does not take
+ * within the send timeout are dropped and counted.
+ */
+struct SyslogSink : AsyncRecordSink
+{
+    static constexpr const char* JOURNAL_SOCKET = "/run/systemd/journal/socket";
+    static constexpr const char* SYSLOG_SOCKET = "/dev/log";
+    static constexpr int FACILITY_USER = 1;
+    static constexpr auto SEND_TIMEOUT = std::chrono::seconds(1);
+
+    explicit SyslogSink(std::string tag, SyslogProtocol protocol = SyslogProtocol::AUTO,
+                        std::string socketPath = "", int facility = FACILITY_USER)
+        : identifier(std::move(tag)), facilityCode(facility), pid(::getpid())
+    {
+        struct stat info {};
+        if (protocol == SyslogProtocol::AUTO) {
+            protocol = (::stat(JOURNAL_SOCKET, &info) == 0) ? SyslogProtocol::JOURNALD : SyslogProtocol::SYSLOG;
+        }
+        journal = protocol == SyslogProtocol::JOURNALD;
+        if (socketPath.empty()) {
+            socketPath = journal ? JOURNAL_SOCKET : SYSLOG_SOCKET;
+        }
+        path = std::move(socketPath);
+        connectSocket();
+    }
+
+    ~SyslogSink() override
+    {
+        stop();
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    void childAfterFork() override
+    {
+        AsyncRecordSink::childAfterFork();
+        // Datagrams do not interleave, so the socket can stay; the syslog header names the child
+        pid = ::getpid();
+    }
+
+    /**
+     * @brief Maps a log level to a syslog severity.
+     */
+    static int severity(LogLevel level)
+    {
+        switch (level) {
+            case LOG_VERBOSE:
+            case LOG_DEBUG:   return 7;  // debug
+            case LOG_INFO:    return 6;  // info
+            case LOG_WARNING: return 4;  // warning
+            case LOG_ERROR:   return 3;  // err
+            case LOG_FATAL:   return 2;  // crit
+            case LOG_FIXED:   return 5;  // notice
+            default:          return 6;
+        }
+    }
+
+    /**
+     * @brief Appends one journal field, in the length-prefixed form if the value spans lines.
+     */
+    static void appendField(std::string& out, const char* key, std::string_view value)
+    {
+        out += key;
+        if (value.find('\n') == std::string_view::npos) {
+            out += '=';
+            out.append(value.data(), value.size());
+        } else {
+            out += '\n';
+            char length[8];
+            logindex::putLE64(length, value.size());
+            out.append(length, sizeof(length));
+            out.append(value.data(), value.size());
+        }
+        out += '\n';
+    }
+
+    /**
+     * @brief Encodes one record as a journal datagram.
+     */
+    void encodeJournal(const Entry& entry, std::string& out) const
+    {
+        const char* level = toString(entry.level);
+        while (*level == ' ') {
+            ++level;
+        }
+        char number[24];
+        std::snprintf(number, sizeof(number), "%d", severity(entry.level));
+        appendField(out, "PRIORITY", number);
+        appendField(out, "SYSLOG_IDENTIFIER", identifier);
+        appendField(out, "ULOG_LEVEL", level);
+        std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(entry.sequence));
+        appendField(out, "ULOG_SEQUENCE", number);
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(entry.time.time_since_epoch()).count();
+        std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(micros));
+        appendField(out, "ULOG_TIMESTAMP", number);
+        if (entry.truncated) {
+            std::string message = entry.message + " [TRUNCATED]";
+            appendField(out, "MESSAGE", message);
+        } else {
+            appendField(out, "MESSAGE", entry.message);
+        }
+    }
+
+    /**
+     * @brief Encodes one record as an RFC 3164 line: "<PRI>Mmm dd hh:mm:ss tag[pid]: message".
+     */
+    void encodeSyslog(const Entry& entry, std::string& out) const
+    {
+        std::time_t seconds = std::chrono::system_clock::to_time_t(entry.time);
+        std::tm local {};
+        ::localtime_r(&seconds, &local);
+        char prefix[64];
+        int written = std::snprintf(prefix, sizeof(prefix), "<%d>", facilityCode * 8 + severity(entry.level));
+        written += static_cast<int>(std::strftime(prefix + written, sizeof(prefix) - written, "%b %e %H:%M:%S ", &local));
+        out.append(prefix, static_cast<size_t>(written));
+        out += identifier;
+        std::snprintf(prefix, sizeof(prefix), "[%d]: ", static_cast<int>(pid));
+        out += prefix;
+        out += entry.message;
+        if (entry.truncated) {
+            out += " [TRUNCATED]";
+        }
+    }
+
+protected:
+    bool send(std::vector<Entry>& batch) override
+    {
+        // Records wait while the daemon is away, e.g. restarting
+        if (fd < 0 && !connectSocket()) {
+            return false;
+        }
+
+        datagrams.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            datagrams[i].clear();
+            if (journal) {
+                encodeJournal(batch[i], datagrams[i]);
+            } else {
+                encodeSyslog(batch[i], datagrams[i]);
+            }
+        }
+
+        size_t sent = 0;
+        while (sent < batch.size()) {
+            int result = sendBatch(sent, batch.size() - sent);
+            if (result > 0) {
+                sent += static_cast<size_t>(result);
+                continue;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EMSGSIZE || errno == ENOBUFS) {
+                // Only this datagram is at fault
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                ++sent;
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Daemon not keeping up within the send timeout: drop the rest
+                dropped.fetch_add(batch.size() - sent, std::memory_order_relaxed);
+                return true;
+            }
+            // Daemon gone: reconnect and send the rest later
+            ::close(fd);
+            fd = -1;
+            batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(sent));
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool connectSocket()
+    {
+        fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        // A stalled daemon must not hold the sink thread forever
+        timeval timeout {static_cast<time_t>(SEND_TIMEOUT.count()), 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Sends @p count datagrams from @p first on; returns how many left, or -1 with errno.
+     */
+    int sendBatch(size_t first, size_t count)
+    {
+#ifdef __linux__
+        vectors.resize(count);
+        messages.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            std::string& datagram = datagrams[first + i];
+            vectors[i].iov_base = datagram.data();
+            vectors[i].iov_len = datagram.size();
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        return ::sendmmsg(fd, messages.data(), static_cast<unsigned>(count), 0);
+#else
+        const std::string& datagram = datagrams[first];
+        return ::send(fd, datagram.data(), datagram.size(), 0) < 0 ? -1 : 1;
+#endif
+    }
+
+    std::string identifier;
+    int facilityCode;
+    pid_t pid;
+    bool journal = false;
+    std::string path;
+    int fd = -1;
+    std::vector<std::string> datagrams;
+#ifdef __linux__
+    std::vector<iovec> vectors;
+    std::vector<mmsghdr> messages;
+#endif
+};
+#endif
+
+#endif // ULOGGER_SYSLOG_H
@@ -0,0 +1,216 @@
+#ifndef ULOGGER_WORKER_H
+#define ULOGGER_WORKER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Background thread running logger housekeeping off the hot path.
+ *
+ * Tasks run one at a time in the order they were posted; timed tasks join
+ * the queue once their deadline passes. The thread is started on the first
+ * post, so loggers that never need it pay nothing.
+ */
+struct LogWorker
+{
+    std::thread thread;
+    std::mutex workerMutex;
+    std::condition_variable wakeup;
+    std::condition_variable idle;
+    std::deque<std::function<void()>> tasks;
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> timers;
+    bool lowPriority = false;
+    bool running = false;
+    bool busy = false;
+    bool stopping = false;
+
+    LogWorker() = default;
+
+    /**
+     * @brief Creates a worker whose thread runs at idle CPU and I/O priority.
+     */
+    explicit LogWorker(bool idlePriority)
+        : lowPriority(idlePriority)
+    {
+    }
+
+    ~LogWorker()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Queues a task for the worker thread.
+     */
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            tasks.push_back(std::move(task));
+            startLocked();
+        }
+        wakeup.notify_one();
+    }
+
+    /**
+     * @brief Queues a task to run once @p when has passed.
+     */
+    void postAt(std::chrono::steady_clock::time_point when, std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            timers.emplace(when, std::move(task));
+            startLocked();
+        }
+        wakeup.notify_one();
+    }
+
+    /**
+     * @brief Blocks until every queued task has finished (pending timers excluded).
+     */
+    void waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(workerMutex);
+        idle.wait(lock, [this] { return !running || (tasks.empty() && !busy); });
+    }
+
+    /**
+     * @brief Waits until every queued task has finished or @p deadline passes.
+     * @return True if the queue drained in time.
+     */
+    bool waitIdleUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(workerMutex);
+        return idle.wait_until(lock, deadline, [this] { return !running || (tasks.empty() && !busy); });
+    }
+
+    /**
+     * @brief Runs the remaining tasks, drops pending timers and joins the thread.
+     */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            if (!running) return;
+            stopping = true;
+        }
+        wakeup.notify_one();
+        thread.join();
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            running = false;
+            timers.clear();
+        }
+        idle.notify_all();
+    }
+
+    /**
+     * @brief Takes the worker lock before fork(), so the child does not inherit it held.
+     */
+    void prepareFork()
+    {
+        workerMutex.lock();
+    }
+
+    void parentAfterFork()
+    {
+        workerMutex.unlock();
+    }
+
+    /**
+     * @brief Resets the worker in a forked child, which has no copy of its thread.
+     *
+     * Queued tasks and timers are dropped: they are the parent's business
+     * (closing its files, say), and a timer the thread was running at the
+     * time of the fork is lost anyway, so the owner re-arms the ones it
+     * needs. They are leaked rather than destroyed because what they hold
+     * may still be in use by the parent's threads in this memory image. The
+     * thread starts again with the next post.
+     */
+    void childAfterFork()
+    {
+        new std::deque<std::function<void()>>(std::move(tasks));
+        new std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>(std::move(timers));
+        tasks.clear();
+        timers.clear();
+        // The copied thread handle and condition variables refer to threads that do not exist here
+        new (&thread) std::thread();
+        new (&wakeup) std::condition_variable();
+        new (&idle) std::condition_variable();
+        running = false;
+        busy = false;
+        stopping = false;
+        workerMutex.unlock();
+    }
+
+private:
+    void startLocked()
+    {
+        if (!running) {
+            running = true;
+            stopping = false;
+            thread = std::thread([this] { run(); });
+        }
+    }
+
+    static void lowerPriority()
+    {
+#ifdef __linux__
+        // Both apply to the calling thread only
+        constexpr int IOPRIO_CLASS_IDLE = 3;
+        constexpr int IOPRIO_WHO_PROCESS = 1;
+        pid_t tid = static_cast<pid_t>(::syscall(SYS_gettid));
+        ::setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 19);
+        ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, IOPRIO_CLASS_IDLE << 13);
+#endif
+    }
+
+    void run()
+    {
+        if (lowPriority) {
+            lowerPriority();
+        }
+
+        std::unique_lock<std::mutex> lock(workerMutex);
+        for (;;) {
+            auto now = std::chrono::steady_clock::now();
+            while (!timers.empty() && timers.begin()->first <= now) {
+                tasks.push_back(std::move(timers.begin()->second));
+                timers.erase(timers.begin());
+            }
+
+            if (!tasks.empty()) {
+                auto task = std::move(tasks.front());
+                tasks.pop_front();
+                busy = true;
+                lock.unlock();
+                task();
+                lock.lock();
+                busy = false;
+                continue;
+            }
+
+            if (stopping) return;
+            idle.notify_all();
+            if (timers.empty()) {
+                wakeup.wait(lock);
+            } else {
+                wakeup.wait_until(lock, timers.begin()->first);
+            }
+        }
+    }
+};
+
+#endif // ULOGGER_WORKER_H